@@ -0,0 +1,189 @@
+// Headless benchmarks of the sandbox scenes, scaled to a given particle count.
+// Results are written as JSON to stdout, or to --output, and a summary goes to stderr.
+//
+// brise_bench [--scenes ballistics,granular] [--particles 1000,1000000]
+//             [--steps 200] [--warmup 20] [--threads 0] [--output results.json]
+
+#include <scenes.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+	struct Options {
+		std::vector<std::string> scenes;
+		std::vector<uint32_t> particles = { 1000, 10000, 100000 };
+		unsigned steps = 200;
+		unsigned warmup = 20;
+		unsigned threads = 0;
+		const char* output = nullptr;
+	};
+
+	struct Result {
+		std::string scene;
+		uint32_t particles = 0;
+		unsigned steps = 0;
+		double setup = 0;   // Seconds building the scene
+		double elapsed = 0; // Seconds stepping it
+		Brise::StepTimings phases;
+		double contacts = 0; // Average per step
+	};
+
+	std::vector<std::string> Split(const char* list) {
+		std::vector<std::string> items;
+		std::string_view rest = list;
+
+		while (not rest.empty()) {
+			size_t comma = rest.find(',');
+			items.emplace_back(rest.substr(0, comma));
+			rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+		}
+		return items;
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options) {
+		for (int i = 1; i < argc; i++) {
+			std::string_view arg = argv[i];
+			if (i + 1 >= argc) return false;
+			const char* value = argv[++i];
+
+			if (arg == "--scenes") options.scenes = Split(value);
+			else if (arg == "--particles") {
+				options.particles.clear();
+				for (const std::string& count : Split(value)) options.particles.push_back(static_cast<uint32_t>(std::strtoul(count.c_str(), nullptr, 10)));
+			}
+			else if (arg == "--steps") options.steps = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+			else if (arg == "--warmup") options.warmup = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+			else if (arg == "--threads") options.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+			else if (arg == "--output") options.output = value;
+			else return false;
+		}
+
+		if (options.scenes.empty()) {
+			options.scenes.assign(std::begin(BriseBench::SCENE_NAMES), std::end(BriseBench::SCENE_NAMES));
+		}
+		return options.steps > 0;
+	}
+
+	double Seconds(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	bool Run(const std::string& name, uint32_t particles, const Options& options, Result& result) {
+		auto start = std::chrono::steady_clock::now();
+		std::unique_ptr<BriseBench::BenchScene> scene = BriseBench::CreateScene(name, particles);
+		if (not scene) return false;
+
+		Brise::World& world = scene->GetWorld();
+		world.SetThreadCount(options.threads);
+
+		result.scene = name;
+		result.particles = world.GetParticleCount();
+		result.steps = options.steps;
+		result.setup = Seconds(start);
+
+		// One fixed step per Update
+		float dt = world.GetFixedTimeStep();
+		for (unsigned i = 0; i < options.warmup; i++) {
+			world.Update(dt);
+		}
+
+		uint64_t contacts = 0;
+		start = std::chrono::steady_clock::now();
+
+		for (unsigned i = 0; i < options.steps; i++) {
+			world.Update(dt);
+
+			const Brise::StepTimings& step = world.GetStepTimings();
+			result.phases.forces += step.forces;
+			result.phases.integration += step.integration;
+			result.phases.contacts += step.contacts;
+			result.phases.islands += step.islands;
+			result.phases.resolution += step.resolution;
+			result.phases.sleeping += step.sleeping;
+			contacts += world.GetContactStats().generated;
+		}
+
+		result.elapsed = Seconds(start);
+		result.contacts = double(contacts) / options.steps;
+		return true;
+	}
+
+	void WriteJson(FILE* file, const Options& options, const std::vector<Result>& results) {
+		// Phase times in microseconds per step
+		auto perStep = [](double seconds, unsigned steps) { return seconds * 1e6 / steps; };
+
+		std::fprintf(file, "{\n  \"benchmark\": \"brise_bench\",\n  \"threads\": %u,\n  \"warmup\": %u,\n  \"results\": [\n",
+			options.threads, options.warmup);
+
+		for (size_t i = 0; i < results.size(); i++) {
+			const Result& r = results[i];
+			const Brise::StepTimings& p = r.phases;
+
+			std::fprintf(file,
+				"    {\n"
+				"      \"scene\": \"%s\",\n"
+				"      \"particles\": %u,\n"
+				"      \"steps\": %u,\n"
+				"      \"setup_seconds\": %.6f,\n"
+				"      \"seconds\": %.6f,\n"
+				"      \"steps_per_second\": %.3f,\n"
+				"      \"ns_per_particle_step\": %.3f,\n"
+				"      \"contacts_per_step\": %.1f,\n"
+				"      \"phase_us_per_step\": { \"forces\": %.3f, \"integration\": %.3f, \"contacts\": %.3f, \"islands\": %.3f, \"resolution\": %.3f, \"sleeping\": %.3f }\n"
+				"    }%s\n",
+				r.scene.c_str(), r.particles, r.steps, r.setup, r.elapsed,
+				r.steps / r.elapsed,
+				r.elapsed * 1e9 / (double(r.steps) * std::max(1u, r.particles)),
+				r.contacts,
+				perStep(p.forces, r.steps), perStep(p.integration, r.steps), perStep(p.contacts, r.steps),
+				perStep(p.islands, r.steps), perStep(p.resolution, r.steps), perStep(p.sleeping, r.steps),
+				i + 1 < results.size() ? "," : "");
+		}
+
+		std::fprintf(file, "  ]\n}\n");
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	if (not ParseOptions(argc, argv, options)) {
+		std::fprintf(stderr, "usage: brise_bench [--scenes a,b] [--particles 1000,1000000] [--steps n] [--warmup n] [--threads n] [--output file]\n");
+		return 1;
+	}
+
+	std::vector<Result> results;
+	std::fprintf(stderr, "%-12s %10s %12s %14s %12s\n", "scene", "particles", "steps/s", "ns/particle", "contacts");
+
+	for (const std::string& name : options.scenes) {
+		for (uint32_t particles : options.particles) {
+			Result result;
+			if (not Run(name, particles, options, result)) {
+				std::fprintf(stderr, "unknown scene %s\n", name.c_str());
+				return 1;
+			}
+
+			std::fprintf(stderr, "%-12s %10u %12.1f %14.2f %12.0f\n", name.c_str(), result.particles,
+				result.steps / result.elapsed, result.elapsed * 1e9 / (double(result.steps) * std::max(1u, result.particles)), result.contacts);
+			results.push_back(result);
+		}
+	}
+
+	FILE* file = options.output ? std::fopen(options.output, "w") : stdout;
+	if (not file) {
+		std::fprintf(stderr, "can't write %s\n", options.output);
+		return 1;
+	}
+
+	WriteJson(file, options, results);
+	if (file != stdout) std::fclose(file);
+	return 0;
+}
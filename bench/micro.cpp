@@ -0,0 +1,388 @@
+// Micro-benchmarks of the innermost routines, each measured on its own.
+// A kernel runs passes of PASS_OPS operations over prepared inputs. Passes are timed
+// with the CPU time stamp counter where there is one, and any state a pass changes
+// is put back between passes, outside of the timed region.
+// Every kernel is warmed up, then sampled repeatedly, and the median cost per
+// operation is reported with its spread over the samples.
+//
+// brise_microbench [--filter name] [--repetitions 31] [--warmup-ms 50] [--output results.json]
+
+#include <Brise/PContact.h>
+#include <Brise/PForceGen.h>
+#include <Brise/PLinks.h>
+#include <Brise/Particle.h>
+#include <Brise/Vec2.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+#endif
+
+namespace {
+
+	constexpr uint32_t PASS_OPS = 1024;
+	constexpr double MIN_SAMPLE_SECONDS = 0.001;
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)) || defined(__x86_64__) || defined(__i386__)
+	// Reference cycles, ticking at the nominal frequency whatever the current clock
+	constexpr const char* CYCLE_UNIT = "cycles";
+	uint64_t ReadCycles() { return __rdtsc(); }
+#else
+	constexpr const char* CYCLE_UNIT = "ns";
+	uint64_t ReadCycles() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+#endif
+
+	// Keeps the compiler from dropping work whose result is never read
+	template<typename T>
+	void DoNotOptimize(const T& value) {
+#if defined(_MSC_VER)
+		static const volatile void* sink;
+		sink = &value;
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	struct Kernel {
+		std::string name;
+		std::function<void()> pass;  // PASS_OPS operations, timed
+		std::function<void()> reset = nullptr; // Restores the inputs the pass changed, not timed, if any
+	};
+
+	struct Measurement {
+		std::string name;
+		double median = 0; // Cycles per operation
+		double min = 0;
+		double p90 = 0;
+		double spread = 0; // Median absolute deviation, relative to the median
+		double nanoseconds = 0;
+		uint64_t passes = 0; // Per sample
+	};
+
+	struct Options {
+		std::string filter;
+		unsigned repetitions = 31;
+		double warmup = 0.05;
+		const char* output = nullptr;
+	};
+
+	// Deterministic inputs, the same on every run
+	class Random {
+	private:
+		uint32_t state = 0x12345678;
+
+	public:
+		float Next(float min, float max) {
+			state = state * 1664525u + 1013904223u;
+			return min + (max - min) * float(state >> 8) / float(1u << 24);
+		}
+
+		Brise::Vec2 NextVec2(float min, float max) {
+			float x = Next(min, max);
+			return { x, Next(min, max) };
+		}
+	};
+
+	// Particles spread in a square, with a pristine copy to reset them from
+	struct Particles {
+		Brise::ParticleStorage storage;
+		Brise::ParticleStorage initial;
+
+		explicit Particles(uint32_t count, float extent = 10) {
+			Random random;
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t p = storage.Add(random.NextVec2(-extent, extent), random.Next(0.5f, 2), 0.99f);
+				storage.velocityX[p] = random.Next(-1, 1);
+				storage.velocityY[p] = random.Next(-1, 1);
+				storage.accelerationY[p] = -9.81f;
+			}
+			initial = storage;
+		}
+
+		Brise::ParticleHandle operator[](uint32_t i) { return Brise::ParticleHandle(&storage, i); }
+
+		// Same sizes, so the columns are copied without reallocating
+		void Reset() { storage = initial; }
+	};
+
+	double Seconds(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Runs passes, returns the timed cycles
+	uint64_t RunPasses(const Kernel& kernel, uint64_t passes) {
+		uint64_t cycles = 0;
+		for (uint64_t i = 0; i < passes; i++) {
+			if (kernel.reset) kernel.reset();
+
+			uint64_t start = ReadCycles();
+			kernel.pass();
+			cycles += ReadCycles() - start;
+		}
+		return cycles;
+	}
+
+	Measurement Measure(const Kernel& kernel, const Options& options) {
+		// Warm up caches, branch predictors and clocks, and find how many passes fill a sample
+		uint64_t passes = 1;
+		auto warmupStart = std::chrono::steady_clock::now();
+		while (true) {
+			auto start = std::chrono::steady_clock::now();
+			RunPasses(kernel, passes);
+			double elapsed = Seconds(start);
+
+			if (elapsed < MIN_SAMPLE_SECONDS) passes *= 2;
+			else if (Seconds(warmupStart) >= options.warmup) break;
+		}
+
+		std::vector<double> samples;
+		double nanoseconds = 0;
+		for (unsigned r = 0; r < options.repetitions; r++) {
+			auto start = std::chrono::steady_clock::now();
+			uint64_t cycles = RunPasses(kernel, passes);
+			nanoseconds += Seconds(start) * 1e9;
+			samples.push_back(double(cycles) / double(passes * PASS_OPS));
+		}
+
+		std::sort(samples.begin(), samples.end());
+		Measurement m;
+		m.name = kernel.name;
+		m.median = samples[samples.size() / 2];
+		m.min = samples.front();
+		m.p90 = samples[samples.size() * 9 / 10];
+		m.passes = passes;
+		// Includes the resets, an upper bound of the time per operation
+		m.nanoseconds = nanoseconds / double(options.repetitions * passes * PASS_OPS);
+
+		std::vector<double> deviations;
+		for (double sample : samples) deviations.push_back(std::abs(sample - m.median));
+		std::sort(deviations.begin(), deviations.end());
+		m.spread = m.median > 0 ? deviations[deviations.size() / 2] / m.median : 0;
+
+		return m;
+	}
+
+	// KERNELS
+
+	std::vector<Kernel> CreateKernels() {
+		std::vector<Kernel> kernels;
+		const float dt = 1.0f / 120.0f;
+
+		// Vec2 arithmetic over arrays of inputs
+		auto a = std::make_shared<std::vector<Brise::Vec2>>();
+		auto b = std::make_shared<std::vector<Brise::Vec2>>();
+		auto out = std::make_shared<std::vector<Brise::Vec2>>(PASS_OPS);
+		auto scalars = std::make_shared<std::vector<float>>(PASS_OPS);
+		Random random;
+		for (uint32_t i = 0; i < PASS_OPS; i++) {
+			a->push_back(random.NextVec2(-10, 10));
+			b->push_back(random.NextVec2(-10, 10));
+		}
+
+		kernels.push_back({ "vec2_add_scale", [=] {
+			for (uint32_t i = 0; i < PASS_OPS; i++) (*out)[i] = (*a)[i] + (*b)[i] * 0.5f;
+			DoNotOptimize(out->data());
+		} });
+		kernels.push_back({ "vec2_dot", [=] {
+			for (uint32_t i = 0; i < PASS_OPS; i++) (*scalars)[i] = Brise::Dot((*a)[i], (*b)[i]);
+			DoNotOptimize(scalars->data());
+		} });
+		kernels.push_back({ "vec2_magnitude", [=] {
+			for (uint32_t i = 0; i < PASS_OPS; i++) (*scalars)[i] = Brise::Magnitude((*a)[i]);
+			DoNotOptimize(scalars->data());
+		} });
+		kernels.push_back({ "vec2_normalize", [=] {
+			for (uint32_t i = 0; i < PASS_OPS; i++) (*out)[i] = Brise::Normalize((*a)[i]);
+			DoNotOptimize(out->data());
+		} });
+		kernels.push_back({ "vec2_distance_squared", [=] {
+			for (uint32_t i = 0; i < PASS_OPS; i++) (*scalars)[i] = Brise::DistanceSquared((*a)[i], (*b)[i]);
+			DoNotOptimize(scalars->data());
+		} });
+
+		// One particle at a time, through its handle
+		auto integrated = std::make_shared<Particles>(PASS_OPS);
+		kernels.push_back({ "particle_integrate", [=] {
+			for (uint32_t i = 0; i < PASS_OPS; i++) (*integrated)[i].Integrate(dt);
+			DoNotOptimize(integrated->storage.positionX.data());
+		}, [=] { integrated->Reset(); } });
+
+		// Contacts between neighbouring particles, closing without penetration for
+		// the velocity pass, and separating with penetration for the interpenetration one
+		auto contactParticles = std::make_shared<Particles>(PASS_OPS + 1);
+		auto closing = std::make_shared<std::vector<Brise::ParticleContact>>(PASS_OPS);
+		auto penetrating = std::make_shared<std::vector<Brise::ParticleContact>>(PASS_OPS);
+		for (uint32_t i = 0; i < PASS_OPS; i++) {
+			Brise::ParticleHandle p0 = (*contactParticles)[i];
+			Brise::ParticleHandle p1 = (*contactParticles)[i + 1];
+			Brise::Vec2 normal = Brise::Normalize(p0.GetPosition() - p1.GetPosition());
+			Brise::Vec2 relativeVelocity = p0.GetVelocity() - p1.GetVelocity();
+			bool approaching = Brise::Dot(relativeVelocity, normal) < 0;
+
+			Brise::ParticleContact contact = {};
+			contact.particle[0] = p0;
+			contact.particle[1] = p1;
+			contact.restitution = 0.5f;
+
+			contact.contactNormal = approaching ? normal : -normal;
+			contact.penetration = 0;
+			(*closing)[i] = contact;
+
+			contact.contactNormal = approaching ? -normal : normal;
+			contact.penetration = 0.05f;
+			(*penetrating)[i] = contact;
+		}
+
+		kernels.push_back({ "contact_resolve_velocity", [=] {
+			for (Brise::ParticleContact& contact : *closing) contact.Resolve(dt);
+			DoNotOptimize(contactParticles->storage.velocityX.data());
+		}, [=] { contactParticles->Reset(); } });
+		kernels.push_back({ "contact_resolve_interpenetration", [=] {
+			for (Brise::ParticleContact& contact : *penetrating) contact.Resolve(dt);
+			DoNotOptimize(contactParticles->storage.positionX.data());
+		}, [=] { contactParticles->Reset(); } });
+
+		// Force generators, one particle per call and then as one batch
+		auto forced = std::make_shared<Particles>(PASS_OPS, 2);
+		auto indices = std::make_shared<std::vector<uint32_t>>();
+		for (uint32_t i = 0; i < PASS_OPS; i++) indices->push_back(i);
+
+		struct Generator {
+			const char* name;
+			std::shared_ptr<Brise::ParticleForceGenerator> fg;
+		};
+
+		Generator generators[] = {
+			{ "gravity", std::make_shared<Brise::ParticleGravity>(Brise::Vec2(0, -9.81f)) },
+			{ "spring", std::make_shared<Brise::ParticleSpring>((*forced)[0], 10, 1) },
+			{ "anchored_spring", std::make_shared<Brise::AnchoredParticleSpring>(Brise::Vec2(0, 5), 10, 1) },
+			{ "bungee", std::make_shared<Brise::ParticleBungee>((*forced)[0], 10, 1) },
+			// Water line through the particles, all three branches are taken
+			{ "buoyancy", std::make_shared<Brise::ParticleBuoyancy>(1.0f, 0.01f, 0.0f) }
+		};
+
+		for (const Generator& generator : generators) {
+			std::shared_ptr<Brise::ParticleForceGenerator> fg = generator.fg;
+
+			kernels.push_back({ std::string("force_") + generator.name, [=] {
+				for (uint32_t i = 0; i < PASS_OPS; i++) fg->UpdateForce((*forced)[i], dt);
+				DoNotOptimize(forced->storage.forceAccumX.data());
+			}, [=] { forced->Reset(); } });
+
+			kernels.push_back({ std::string("force_") + generator.name + "_batch", [=] {
+				fg->UpdateForces(forced->storage, *indices, dt);
+				DoNotOptimize(forced->storage.forceAccumX.data());
+			}, [=] { forced->Reset(); } });
+		}
+
+		// Links between random pairs, half of them off their length so they make contacts
+		auto linked = std::make_shared<Particles>(2 * PASS_OPS, 2);
+		auto rods = std::make_shared<std::vector<Brise::ParticleRod>>(PASS_OPS);
+		auto cables = std::make_shared<std::vector<Brise::ParticleCable>>(PASS_OPS);
+		auto linkContacts = std::make_shared<std::vector<Brise::ParticleContact>>(PASS_OPS);
+
+		for (uint32_t i = 0; i < PASS_OPS; i++) {
+			Brise::ParticleHandle p0 = (*linked)[2 * i];
+			Brise::ParticleHandle p1 = (*linked)[2 * i + 1];
+			float length = Brise::Magnitude(p1.GetPosition() - p0.GetPosition());
+			float target = i % 2 ? length : length * random.Next(0.5f, 1.5f);
+
+			(*rods)[i].particle[0] = p0;
+			(*rods)[i].particle[1] = p1;
+			(*rods)[i].length = target;
+
+			(*cables)[i].particle[0] = p0;
+			(*cables)[i].particle[1] = p1;
+			(*cables)[i].maxLength = target;
+			(*cables)[i].restitution = 0.2f;
+		}
+
+		kernels.push_back({ "rod_add_contact", [=] {
+			unsigned used = 0;
+			for (const Brise::ParticleRod& rod : *rods) used += rod.AddContact((*linkContacts)[used], PASS_OPS - used);
+			DoNotOptimize(used);
+		} });
+		kernels.push_back({ "cable_add_contact", [=] {
+			unsigned used = 0;
+			for (const Brise::ParticleCable& cable : *cables) used += cable.AddContact((*linkContacts)[used], PASS_OPS - used);
+			DoNotOptimize(used);
+		} });
+
+		return kernels;
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options) {
+		for (int i = 1; i < argc; i++) {
+			std::string_view arg = argv[i];
+			if (i + 1 >= argc) return false;
+			const char* value = argv[++i];
+
+			if (arg == "--filter") options.filter = value;
+			else if (arg == "--repetitions") options.repetitions = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+			else if (arg == "--warmup-ms") options.warmup = std::strtod(value, nullptr) / 1000;
+			else if (arg == "--output") options.output = value;
+			else return false;
+		}
+		return options.repetitions > 0;
+	}
+
+	void WriteJson(FILE* file, const std::vector<Measurement>& measurements, const Options& options) {
+		std::fprintf(file, "{\n  \"benchmark\": \"brise_microbench\",\n  \"unit\": \"%s\",\n  \"repetitions\": %u,\n  \"results\": [\n",
+			CYCLE_UNIT, options.repetitions);
+
+		for (size_t i = 0; i < measurements.size(); i++) {
+			const Measurement& m = measurements[i];
+			std::fprintf(file,
+				"    { \"kernel\": \"%s\", \"median\": %.3f, \"min\": %.3f, \"p90\": %.3f, \"spread\": %.4f, \"ns_per_op\": %.3f }%s\n",
+				m.name.c_str(), m.median, m.min, m.p90, m.spread, m.nanoseconds, i + 1 < measurements.size() ? "," : "");
+		}
+
+		std::fprintf(file, "  ]\n}\n");
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	if (not ParseOptions(argc, argv, options)) {
+		std::fprintf(stderr, "usage: brise_microbench [--filter name] [--repetitions n] [--warmup-ms n] [--output file]\n");
+		return 1;
+	}
+
+	std::vector<Measurement> measurements;
+	std::printf("%-34s %10s %10s %10s %8s %10s\n", "kernel", CYCLE_UNIT, "min", "p90", "spread", "ns/op");
+
+	for (const Kernel& kernel : CreateKernels()) {
+		if (kernel.name.find(options.filter) == std::string::npos) continue;
+
+		Measurement m = Measure(kernel, options);
+		std::printf("%-34s %10.2f %10.2f %10.2f %7.1f%% %10.2f\n", m.name.c_str(), m.median, m.min, m.p90, m.spread * 100, m.nanoseconds);
+		measurements.push_back(m);
+	}
+
+	if (options.output) {
+		FILE* file = std::fopen(options.output, "w");
+		if (not file) {
+			std::fprintf(stderr, "can't write %s\n", options.output);
+			return 1;
+		}
+		WriteJson(file, measurements, options);
+		std::fclose(file);
+	}
+	return 0;
+}
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <Brise/World.h>
+#include <Brise/PBroadphase.h>
+#include <Brise/PForceGen.h>
+#include <Brise/PLinks.h>
+#include <Brise/PSpringNetwork.h>
+#include <Brise/StaticGeometry.h>
+#include <Brise/Vec2.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace BriseBench {
+
+	// Headless version of a sandbox demo, repeated until it holds about the requested particle count
+	class BenchScene {
+	protected:
+		Brise::World world;
+
+	public:
+		explicit BenchScene(uint32_t particles, float fixedTimeStep = 1.0f / 120.0f)
+			: world(particles, fixedTimeStep) {
+		}
+		virtual ~BenchScene() = default;
+
+		Brise::World& GetWorld() { return world; }
+	};
+
+	// Bullets of the four ballistics demo types, integration only
+	class BallisticsScene : public BenchScene {
+	public:
+		explicit BallisticsScene(uint32_t count) : BenchScene(count) {
+			for (uint32_t i = 0; i < count; i++) {
+				Brise::ParticleHandle p = world.AddParticule({ -10, (i / 4) * 0.01f }, 1, 0.999f);
+
+				switch (i % 4) {
+				case 0: // Pistol
+					p.SetVelocity({ 35, 0 });
+					p.SetAcceleration({ 0, -1 });
+					p.SetMass(2);
+					break;
+				case 1: // Artillery
+					p.SetVelocity({ 10, 15 });
+					p.SetAcceleration({ 0, -20 });
+					p.SetMass(200);
+					break;
+				case 2: // Fireball
+					p.SetVelocity({ 10, 0 });
+					p.SetAcceleration({ 0, 0.6f });
+					p.SetDamping(0.7f);
+					break;
+				case 3: // Laser
+					p.SetVelocity({ 100, 0 });
+					p.SetAcceleration({ 0, 0 });
+					p.SetMass(0.1f);
+					break;
+				}
+			}
+		}
+	};
+
+	// A cloth of springs with bungee diagonals, hanging from its top row and pulled by an anchored spring
+	class SpringsScene : public BenchScene {
+	private:
+		std::unique_ptr<Brise::ParticleSpringNetwork> springs;
+		std::unique_ptr<Brise::AnchoredParticleSpring> anchoredSpring;
+
+	public:
+		explicit SpringsScene(uint32_t count) : BenchScene(count) {
+			const float spacing = 0.2f;
+			uint32_t width = std::max(2u, static_cast<uint32_t>(std::sqrt(float(count))));
+			uint32_t height = std::max(2u, count / width);
+
+			for (uint32_t y = 0; y < height; y++) {
+				for (uint32_t x = 0; x < width; x++) {
+					Brise::ParticleHandle p = world.AddParticule({ x * spacing, -(y * spacing) }, 0.1f, 0.9f);
+					if (y == 0) p.SetInfiniteMass();
+				}
+			}
+
+			springs = std::make_unique<Brise::ParticleSpringNetwork>(&world.GetParticles());
+			auto at = [&](uint32_t x, uint32_t y) { return world.GetParticle(y * width + x); };
+
+			for (uint32_t y = 0; y < height; y++) {
+				for (uint32_t x = 0; x < width; x++) {
+					if (x + 1 < width) springs->AddSpring(at(x, y), at(x + 1, y), 50, spacing);
+					if (y + 1 < height) springs->AddSpring(at(x, y), at(x, y + 1), 50, spacing);
+					if (x + 1 < width && y + 1 < height) springs->AddBungee(at(x, y), at(x + 1, y + 1), 10, spacing * std::sqrt(2.0f));
+				}
+			}
+			world.AddSpringNetwork(springs.get());
+
+			anchoredSpring = std::make_unique<Brise::AnchoredParticleSpring>(Brise::Vec2(width * spacing / 2, -(height * spacing) - 2), 5, 1);
+			for (uint32_t x = 0; x < width; x++) {
+				world.AddForceGenToRegistry(at(x, height - 1), anchoredSpring.get());
+			}
+
+			world.SetIntegrator(Brise::IntegratorType::SemiImplicitEuler);
+		}
+	};
+
+	// Floating particles of the three buoyancy demo sizes
+	class BuoyancyScene : public BenchScene {
+	private:
+		std::unique_ptr<Brise::ParticleBuoyancy> buoyancy[3];
+
+	public:
+		explicit BuoyancyScene(uint32_t count) : BenchScene(count) {
+			buoyancy[0] = std::make_unique<Brise::ParticleBuoyancy>(0.25f, 0.006f, 1);
+			buoyancy[1] = std::make_unique<Brise::ParticleBuoyancy>(0.25f, 0.02f, 1);
+			buoyancy[2] = std::make_unique<Brise::ParticleBuoyancy>(0.25f, 0.01f, 1);
+			const float masses[3] = { 0.5f, 1.0f, 5.0f };
+
+			for (uint32_t i = 0; i < count; i++) {
+				Brise::ParticleHandle p = world.AddParticule({ (i % 1000) * 0.1f, 3 + (i / 1000) * 0.1f }, masses[i % 3], 0.6f);
+				world.AddForceGenToRegistry(p, buoyancy[i % 3].get());
+			}
+		}
+	};
+
+	// Stacks of ten particles resting on the ground, with the impulse solver and sleeping
+	class RestingScene : public BenchScene {
+	private:
+		std::unique_ptr<Brise::GridBroadphase> broadphase;
+		Brise::StaticGeometry level;
+		std::unique_ptr<Brise::StaticContactGenerator> ground;
+
+	public:
+		explicit RestingScene(uint32_t count) : BenchScene(count) {
+			const float radius = 0.33f;
+			const uint32_t stackHeight = 10;
+
+			for (uint32_t i = 0; i < count; i++) {
+				Brise::ParticleHandle p = world.AddParticule({ (i / stackHeight) * 1.0f, radius + (i % stackHeight) * 2 * radius }, 1.0f, 0.99f);
+				p.SetRadius(radius);
+			}
+
+			world.SetContactSolver(Brise::ContactSolver::SequentialImpulse);
+			world.SetSleeping(true);
+
+			broadphase = std::make_unique<Brise::GridBroadphase>(&world.GetParticles());
+			world.AddContactGenerator(broadphase.get());
+
+			level.AddPlane({ 0, 1 }, 0);
+			level.Build();
+			ground = std::make_unique<Brise::StaticContactGenerator>(&world.GetParticles(), &level);
+			world.AddContactGenerator(ground.get());
+		}
+	};
+
+	// Cubes of four particles held by six rigid rods, falling on the ground
+	class CubeScene : public BenchScene {
+	private:
+		Brise::StaticGeometry level;
+		std::unique_ptr<Brise::StaticContactGenerator> ground;
+
+	public:
+		explicit CubeScene(uint32_t count) : BenchScene(count, 1.0f / 60.0f) {
+			const float size = 1.0f;
+			const float edge = 2 * size;
+			const float diagonal = std::sqrt(2.0f) * edge;
+
+			for (uint32_t cube = 0; cube < std::max(1u, count / 4); cube++) {
+				// Tilted a little so they land on a corner
+				float x = (cube % 1000) * 3.0f;
+				float y = 3.0f + (cube / 1000) * 3.0f;
+				float tilt = 0.1f * (cube % 7);
+
+				Brise::ParticleHandle p0 = world.AddParticule({ x - size, y + tilt }, 1.0f, 0.99f);
+				Brise::ParticleHandle p1 = world.AddParticule({ x + size, y }, 1.0f, 0.99f);
+				Brise::ParticleHandle p2 = world.AddParticule({ x + size, y - edge }, 1.0f, 0.99f);
+				Brise::ParticleHandle p3 = world.AddParticule({ x - size, y - edge + tilt }, 1.0f, 0.99f);
+
+				world.constraints.AddDistance(p0, p1, edge);
+				world.constraints.AddDistance(p1, p2, edge);
+				world.constraints.AddDistance(p2, p3, edge);
+				world.constraints.AddDistance(p3, p0, edge);
+				world.constraints.AddDistance(p0, p2, diagonal);
+				world.constraints.AddDistance(p1, p3, diagonal);
+			}
+
+			level.AddPlane({ 0, 1 }, 0);
+			level.Build();
+			ground = std::make_unique<Brise::StaticContactGenerator>(&world.GetParticles(), &level);
+			ground->restitution = 0.2f;
+			world.AddContactGenerator(ground.get());
+		}
+	};
+
+	// Bridges of ten particles linked by cables, fixed at both ends
+	class BridgeScene : public BenchScene {
+	private:
+		std::unique_ptr<Brise::ParticleCableSet> cables;
+
+	public:
+		explicit BridgeScene(uint32_t count) : BenchScene(count) {
+			const uint32_t segmentCount = 10;
+			const float segmentLength = 1.2f;
+
+			cables = std::make_unique<Brise::ParticleCableSet>(&world.GetParticles());
+
+			for (uint32_t bridge = 0; bridge < std::max(1u, count / segmentCount); bridge++) {
+				float x = -6.0f + (bridge % 100) * segmentCount * segmentLength * 1.5f;
+				float y = 1.0f + (bridge / 100) * 5.0f;
+
+				uint32_t first = world.GetParticleCount();
+				for (uint32_t i = 0; i < segmentCount; i++) {
+					world.AddParticule({ x + i * segmentLength, y }, 1.0f, 0.99f);
+				}
+
+				world.GetParticle(first).SetInfiniteMass();
+				world.GetParticle(first + segmentCount - 1).SetInfiniteMass();
+
+				for (uint32_t i = 0; i + 1 < segmentCount; i++) {
+					cables->AddCable(world.GetParticle(first + i), world.GetParticle(first + i + 1), segmentLength, 0.2f);
+				}
+			}
+
+			world.AddContactGenerator(cables.get());
+		}
+	};
+
+	// Grains poured between two walls onto a wedge and the ground, settling into piles
+	class GranularScene : public BenchScene {
+	private:
+		std::unique_ptr<Brise::GridBroadphase> broadphase;
+		Brise::StaticGeometry level;
+		std::unique_ptr<Brise::StaticContactGenerator> ground;
+
+	public:
+		explicit GranularScene(uint32_t count) : BenchScene(count) {
+			const float radius = 0.1f;
+			const float spacing = 2.2f * radius;
+			uint32_t columns = std::max(1u, static_cast<uint32_t>(std::sqrt(float(count)) * 2));
+			float halfWidth = columns * spacing / 2 + radius;
+
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t column = i % columns;
+				uint32_t row = i / columns;
+				// Odd rows shifted so the grains don't stack in perfect columns
+				float x = -halfWidth + radius + column * spacing + (row % 2) * radius * 0.5f;
+				Brise::ParticleHandle p = world.AddParticule({ x, 2 + row * spacing }, 0.05f, 0.99f);
+				p.SetRadius(radius);
+			}
+
+			world.SetContactSolver(Brise::ContactSolver::SequentialImpulse);
+			world.SetSleeping(true);
+
+			broadphase = std::make_unique<Brise::GridBroadphase>(&world.GetParticles());
+			world.AddContactGenerator(broadphase.get());
+
+			level.AddPlane({ 0, 1 }, 0);
+			level.AddPlane({ 1, 0 }, -halfWidth);
+			level.AddPlane({ -1, 0 }, -halfWidth);
+			std::vector<Brise::Vec2> wedge = { { -1, 0 }, { 1, 0 }, { 0, 1 } };
+			level.AddPolygon(wedge);
+			level.Build();
+			ground = std::make_unique<Brise::StaticContactGenerator>(&world.GetParticles(), &level);
+			world.AddContactGenerator(ground.get());
+		}
+	};
+
+	constexpr std::string_view SCENE_NAMES[] = { "ballistics", "springs", "buoyancy", "resting", "cube", "bridge", "granular" };
+
+	// nullptr for an unknown name
+	inline std::unique_ptr<BenchScene> CreateScene(std::string_view name, uint32_t particles) {
+		if (name == "ballistics") return std::make_unique<BallisticsScene>(particles);
+		if (name == "springs") return std::make_unique<SpringsScene>(particles);
+		if (name == "buoyancy") return std::make_unique<BuoyancyScene>(particles);
+		if (name == "resting") return std::make_unique<RestingScene>(particles);
+		if (name == "cube") return std::make_unique<CubeScene>(particles);
+		if (name == "bridge") return std::make_unique<BridgeScene>(particles);
+		if (name == "granular") return std::make_unique<GranularScene>(particles);
+		return nullptr;
+	}
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <Brise/World.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Brise {
+
+	// State of the particles after a step, as published by an AsyncWorld
+	struct WorldSnapshot {
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> velocityX;
+		std::vector<float> velocityY;
+		std::vector<float> previousPositionX; // Before the last step, for interpolation
+		std::vector<float> previousPositionY;
+		uint64_t steps = 0;      // Steps taken by the world when the snapshot was made
+		float accumulator = 0;   // Time left in the accumulator after the Update
+		float fixedTimeStep = 0;
+		std::chrono::steady_clock::time_point publishTime;
+
+		uint32_t Size() const { return static_cast<uint32_t>(positionX.size()); }
+		Vec2 GetPosition(uint32_t index) const { return { positionX[index], positionY[index] }; }
+		Vec2 GetVelocity(uint32_t index) const { return { velocityX[index], velocityY[index] }; }
+
+		// The simulation sleeps until the next step is due, so the alpha depends on when the
+		// snapshot is read: the accumulator plus the time since it was published, in [0, 1]
+		float GetAlpha(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now()) const {
+			if (fixedTimeStep <= 0) return 1;
+			float elapsed = std::chrono::duration<float>(now - publishTime).count();
+			return std::clamp((accumulator + elapsed) / fixedTimeStep, 0.0f, 1.0f);
+		}
+
+		// Blended alpha of the way from the previous step, see World::GetInterpolatedPositions
+		Vec2 GetInterpolatedPosition(uint32_t index, float alpha) const {
+			return {
+				previousPositionX[index] + (positionX[index] - previousPositionX[index]) * alpha,
+				previousPositionY[index] + (positionY[index] - previousPositionY[index]) * alpha
+			};
+		}
+	};
+
+	// Runs a World on its own thread, in real time.
+	// After every Update the particles are copied to one of three snapshots, and the
+	// reader swaps the newest one in without ever waiting for the simulation, nor the
+	// simulation for the reader. Once started, the world must only be changed through
+	// commands, which the simulation thread runs before its next Update.
+	class AsyncWorld {
+	public:
+		using Command = std::function<void(World&)>;
+
+	private:
+		World& world;
+
+		std::thread thread;
+		std::atomic<bool> running = false;
+
+		std::mutex commandMutex;
+		std::condition_variable wake;
+		std::vector<Command> commands;
+		std::vector<Command> runningCommands; // Swapped with commands, only touched by the simulation thread
+
+		// Triple buffer: the simulation writes back, the reader owns front, and
+		// middle holds the last published snapshot along with a fresh flag
+		static constexpr uint8_t FRESH = 4;
+		static constexpr uint8_t INDEX_MASK = 3;
+		WorldSnapshot snapshots[3];
+		uint8_t back = 0;
+		std::atomic<uint8_t> middle = 1;
+		uint8_t front = 2;
+
+		uint64_t steps = 0;
+
+	public:
+		explicit AsyncWorld(World& world);
+		~AsyncWorld();
+
+		AsyncWorld(const AsyncWorld&) = delete;
+		AsyncWorld& operator=(const AsyncWorld&) = delete;
+
+		void Start();
+		// Waits for the current Update to finish, pending commands are run before returning
+		void Stop();
+		bool IsRunning() const { return running.load(std::memory_order_relaxed); }
+
+		// Can be called from any thread, the command runs on the simulation thread.
+		// Commands run in the order they were submitted.
+		void Submit(Command command);
+
+		// Common commands. Particle indices are only known once the command ran,
+		// onAdded receives the new particle on the simulation thread.
+		void AddParticle(Vec2 position, float mass, float damping, std::function<void(ParticleHandle)> onAdded = {});
+		void ApplyImpulse(uint32_t particle, Vec2 impulse);
+		void AddContactGenerator(ParticleContactGenerator* generator);
+		void RemoveContactGenerator(ParticleContactGenerator* generator);
+		void AddForceGenerator(uint32_t particle, ParticleForceGenerator* generator);
+
+		// Newest published snapshot, valid until the next call. A single thread may read.
+		const WorldSnapshot& AcquireSnapshot();
+
+	private:
+		void Run();
+		void RunCommands();
+		void Publish();
+	};
+
+}
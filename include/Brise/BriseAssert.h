@@ -1,9 +1,17 @@
 #pragma once
 
+#include <iostream>
+
+#if defined(_MSC_VER)
+	#define BR_DEBUG_BREAK() __debugbreak()
+#else
+	#define BR_DEBUG_BREAK() __builtin_trap()
+#endif
+
 #define BR_ASSERT(expr) \
 	if (expr) { } \
 	else \
 	{ \
 		std::cerr << "Assertion not passed." << std::endl; \
-		__debugbreak(); \
-	}
\ No newline at end of file
+		BR_DEBUG_BREAK(); \
+	}
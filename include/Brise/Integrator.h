@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Brise/Particle.h>
+#include <Brise/ThreadPool.h>
+
+namespace Brise {
+
+	// Instruction sets the batched kernels can run on
+	enum class SimdLevel {
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+	// Best instruction set supported by the running CPU
+	SimdLevel DetectSimdLevel();
+
+	// Instruction set used by the batched kernels, defaults to DetectSimdLevel().
+	// It can be lowered to compare kernels, and is clamped to what the CPU supports.
+	SimdLevel GetSimdLevel();
+	void SetSimdLevel(SimdLevel level);
+
+	// Integration schemes, all taking the forces accumulated at the start of the step.
+	// The symplectic ones keep springs and orbits stable at larger time steps.
+	enum class IntegratorType {
+		Euler,             // Moves with the old velocity, then updates it. First order, gains energy
+		SemiImplicitEuler, // Updates the velocity, then moves with it. First order, symplectic
+		PositionVerlet,    // Stormer-Verlet, x' = x + (x - xPrevious) * damping + a dt^2, the velocity standing for
+		                   // (x - xPrevious) / dt so contacts can change it. Second order in position, symplectic
+		VelocityVerlet     // Moves with the velocity and half the acceleration, then corrects the velocity
+		                   // with the next step's acceleration. Second order, symplectic
+	};
+
+	// Integrates every particle of the storage forward in time by the given amount,
+	// then clears the force accumulators. Particles with infinite mass or asleep don't move.
+	// With a pool, blocks of particles are integrated in parallel, with the same results.
+	void IntegrateParticles(ParticleStorage& particles, float duration, ThreadPool* pool = nullptr,
+		IntegratorType type = IntegratorType::Euler);
+
+	// Integrates a single particle exactly as IntegrateParticles would, see ParticleHandle::Integrate
+	void IntegrateParticle(ParticleStorage& particles, uint32_t index, float duration,
+		IntegratorType type = IntegratorType::Euler);
+
+}
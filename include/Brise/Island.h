@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Brise/PContact.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Brise {
+
+	// Groups of simulated particles connected by contacts or links, rebuilt every step
+	// with a union-find. Islands don't interact with each other, so they can be solved
+	// independently, and an island resting long enough is put to sleep as a whole.
+	// Infinite mass particles never join islands, so they don't merge the islands resting on them.
+	class ParticleIslands {
+	public:
+		float sleepEnergy = 0.001f; // Mean kinetic energy per particle under which an island rests
+		unsigned sleepSteps = 60;   // Steps an island has to rest before falling asleep
+
+	private:
+		std::vector<uint32_t> parent;        // Union-find forest over the particles
+		std::vector<uint32_t> islandOf;      // Island of each simulated particle
+		std::vector<uint32_t> particleStart; // Island i holds particles[particleStart[i], particleStart[i + 1])
+		std::vector<uint32_t> particles;
+		std::vector<uint32_t> contactStart;  // Island i holds contacts[contactStart[i], contactStart[i + 1])
+		std::vector<uint32_t> contacts;
+
+		std::vector<uint32_t> sleepGroup;    // First particle of the island each sleeping particle fell asleep with
+		std::vector<uint32_t> nextAsleep;    // Next particle of the same sleep group, groups wake as a whole so the lists stay intact
+		std::vector<uint8_t> wakeGroup;
+
+	public:
+		// Wakes the sleeping islands touched by simulated particles, then groups the simulated particles.
+		// links are the pairs kept together even without contact, see ParticleContactGenerator::CollectLinks.
+		void Build(ParticleStorage& storage, const std::vector<ParticleContact>& contactArray, unsigned numContacts,
+			std::span<const ParticleLinkPair> links);
+
+		// Counts the steps each island spent under sleepEnergy, and puts to sleep those resting for sleepSteps
+		void UpdateSleep(ParticleStorage& storage);
+
+		void WakeAll(ParticleStorage& storage);
+		// Wakes a particle along with the island it fell asleep with, as a contact with it would.
+		// Only visits the particles of that island.
+		void WakeIsland(ParticleStorage& storage, uint32_t particle);
+
+		// Island each sleeping particle fell asleep with, saved with the world state
+		std::span<const uint32_t> GetSleepGroups() const { return sleepGroup; }
+		void SetSleepGroups(std::span<const uint32_t> groups);
+
+		uint32_t GetIslandCount() const { return particleStart.empty() ? 0 : static_cast<uint32_t>(particleStart.size()) - 1; }
+
+		// Particle and contact indices of an island, valid until the next Build
+		std::span<const uint32_t> GetParticles(uint32_t island) const;
+		std::span<const uint32_t> GetContacts(uint32_t island) const;
+
+	private:
+		uint32_t Find(uint32_t particle);
+		void Union(uint32_t a, uint32_t b);
+
+		// Wakes b if a moves, and the other way around
+		void Touch(ParticleStorage& storage, const ParticleHandle& a, const ParticleHandle& b);
+		void Wake(ParticleStorage& storage, uint32_t particle);
+	};
+
+}
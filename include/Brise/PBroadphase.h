@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Brise/PContact.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Brise {
+
+	// Base of the generators detecting collisions between the particles of a storage.
+	// Particles are disks of their radius, those with a zero radius never collide.
+	class ParticleBroadphase : public ParticleContactGenerator {
+	public:
+		float restitution = 0;
+
+	protected:
+		ParticleStorage* particles;
+
+	public:
+		ParticleBroadphase(ParticleStorage* particles);
+
+		ParticleStorage* GetStorage() const { return particles; }
+
+	protected:
+		// Narrow phase, fills the contact and returns true if particles a and b overlap
+		bool Collide(uint32_t a, uint32_t b, ParticleContact& contact) const;
+	};
+
+	// Uniform grid broadphase.
+	// Particles are bucketed by cell into a spatial hash rebuilt in linear time
+	// every step, then only tested against the particles of the neighbouring cells.
+	// With a thread pool, ranges of particles are tested in parallel.
+	class GridBroadphase : public ParticleBroadphase {
+	public:
+		// Cell edge length, grown to the largest particle diameter if smaller.
+		// Zero picks the largest diameter.
+		float cellSize;
+
+	private:
+		mutable std::vector<int32_t> cellX;
+		mutable std::vector<int32_t> cellY;
+		mutable std::vector<uint32_t> bucketStart; // Bucket b holds entries [bucketStart[b], bucketStart[b + 1])
+		mutable std::vector<uint32_t> entries;     // Particle indices sorted by bucket
+
+		mutable uint32_t bucketMask = 0;
+
+	public:
+		GridBroadphase(ParticleStorage* particles, float cellSize = 0);
+
+		virtual unsigned AddContact(ParticleContact& contact, unsigned limit) const override;
+
+	private:
+		uint32_t Bucket(int32_t x, int32_t y) const;
+		float Build() const;
+
+		// Contacts of particle i with the higher index particles around it
+		unsigned CollideParticle(uint32_t i, ParticleContact* output, unsigned limit) const;
+	};
+
+	// Sort and sweep broadphase along the x axis.
+	// Particles are kept sorted by the left edge of their disk with an insertion sort,
+	// which is close to linear as the order barely changes between steps.
+	// Unlike the grid it doesn't depend on a cell size, so it copes with very
+	// different particle sizes.
+	class SweepAndPruneBroadphase : public ParticleBroadphase {
+	private:
+		mutable std::vector<uint32_t> order; // Particle indices sorted by minX
+		mutable std::vector<float> minX;     // Left edge of each particle in order
+
+	public:
+		SweepAndPruneBroadphase(ParticleStorage* particles);
+
+		virtual unsigned AddContact(ParticleContact& contact, unsigned limit) const override;
+
+	private:
+		void Sort() const;
+
+		// Contacts of the k-th particle in order with the ones after it
+		unsigned SweepParticle(uint32_t k, ParticleContact* output, unsigned limit) const;
+	};
+
+	enum class BroadphaseType {
+		Grid,
+		SweepAndPrune
+	};
+
+	std::unique_ptr<ParticleBroadphase> CreateBroadphase(BroadphaseType type, ParticleStorage* particles);
+
+}
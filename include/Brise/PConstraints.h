@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Brise/PContact.h>
+#include <Brise/Particle.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Brise {
+
+	// Position based (XPBD) solver for distance constraints, rods and cables kept
+	// stiff without going through contacts.
+	// Each step is split in substeps: the constrained particles are moved with their
+	// velocity and the acceleration they had at the start of the step, then every
+	// constraint projects them back, and velocities are taken from the corrected positions.
+	// Compliance is the inverse stiffness in m/N, 0 makes a constraint rigid.
+	// Constraints are kept in flat arrays over the particles they involve, gathered
+	// once per step and written back once at the end.
+	class ParticleConstraintSolver {
+
+	public:
+		unsigned substeps = 8;   // Substeps per world step
+		unsigned iterations = 1; // Projections of every constraint per substep
+
+	private:
+		struct Constraint {
+			ParticleHandle a;
+			ParticleHandle b;
+			float length;
+			float compliance;
+			bool maxDistance;
+		};
+
+		std::vector<Constraint> added; // In insertion order, compiled by Build
+		bool dirty = false;
+
+		// Compiled constraints, referencing bodies
+		std::vector<uint32_t> bodyA;
+		std::vector<uint32_t> bodyB;
+		std::vector<float> length;
+		std::vector<float> compliance;
+		std::vector<uint8_t> maxDistance; // 1 for cables, which only pull
+		std::vector<float> lambda;        // Accumulated multiplier, reset every substep
+
+		// Particles involved in at least one constraint
+		std::vector<uint32_t> bodyParticle;
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> previousX;
+		std::vector<float> previousY;
+		std::vector<float> velocityX;
+		std::vector<float> velocityY;
+		std::vector<float> accelerationX;
+		std::vector<float> accelerationY;
+		std::vector<float> inverseMass;   // 0 for sleeping particles, which act as anchors
+		bool prepared = false;
+
+	public:
+		// Keeps the particles exactly length apart
+		uint32_t AddDistance(ParticleHandle a, ParticleHandle b, float length, float compliance = 0);
+		// Keeps the particles at most maxLength apart
+		uint32_t AddMaxDistance(ParticleHandle a, ParticleHandle b, float maxLength, float compliance = 0);
+
+		// Removes a constraint, the following ones move down one index
+		void Remove(uint32_t constraint);
+		void Clear();
+
+		uint32_t GetConstraintCount() const { return static_cast<uint32_t>(added.size()); }
+		ParticleHandle GetParticle(uint32_t constraint, unsigned end) const;
+		float GetLength(uint32_t constraint) const { return added[constraint].length; }
+		float GetCompliance(uint32_t constraint) const { return added[constraint].compliance; }
+		bool IsMaxDistance(uint32_t constraint) const { return added[constraint].maxDistance; }
+
+		// Compiles the added constraints, done by Prepare if needed
+		void Build();
+
+		// Records the constrained particles state, called after the forces are accumulated and before integration
+		void Prepare(ParticleStorage& storage);
+
+		// Replaces the integration of the constrained particles by substeps projecting the constraints
+		void Solve(ParticleStorage& storage, float duration);
+
+		// Appends the constrained particle pairs, they always end up in the same island
+		void CollectLinks(std::vector<ParticleLinkPair>& links) const;
+
+	private:
+		uint32_t Add(ParticleHandle a, ParticleHandle b, float length, float compliance, bool maxDistance);
+		void Project(float substepDuration);
+	};
+
+}
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <Brise/Particle.h>
+#include <Brise/ThreadPool.h>
 #include <Brise/Vec2.h>
 
+#include <algorithm>
 #include <limits>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace Brise {
@@ -13,12 +17,15 @@ namespace Brise {
 	public:
 		// Holds the particles involved in the contact
 		// Second can be null for contacts with the scenery
-		Particle* particle[2];
+		ParticleHandle particle[2];
 
 		float restitution;
 		Vec2 contactNormal;
 		float penetration;
 
+		// How far each particle was moved by the last interpenetration resolution
+		Vec2 particleMovement[2];
+
 	public:
 
 		void Resolve(float duration);
@@ -31,6 +38,10 @@ namespace Brise {
 
 	};
 
+	// Resolves contacts by order of severity.
+	// Contacts are kept in a min-heap keyed by separating velocity, and a
+	// particle to contacts index lets each resolution update and re-key only
+	// the contacts sharing a particle with the one just resolved.
 	class ParticleContactResolver {
 		
 	protected:
@@ -38,18 +49,118 @@ namespace Brise {
 		unsigned iterations;
 		unsigned iterationsUsed = 0;
 
+	private:
+
+		// Scratch buffers kept between calls to avoid reallocating
+		std::vector<float> keys;             // Separating velocity per contact, +inf if nothing to resolve
+		std::vector<unsigned> heap;          // Contact indices, heap ordered by key
+		std::vector<unsigned> heapPosition;  // Position of each contact in heap
+		std::vector<unsigned> adjacencyStart; // Contacts of particle i are adjacency[adjacencyStart[i], adjacencyStart[i + 1])
+		std::vector<unsigned> adjacency;
+
 	public:
 
 		ParticleContactResolver(unsigned iterations);
 
 		void SetIterations(unsigned iterations);
+		// Resolutions done by the last ResolveContacts, at most the iterations
+		unsigned GetIterationsUsed() const { return iterationsUsed; }
 		void ResolveContacts(std::vector<ParticleContact>& contactArray, unsigned numContacts, float duration);
 
+	private:
+
+		float Key(const ParticleContact& contact) const;
+		void BuildAdjacency(const std::vector<ParticleContact>& contactArray, unsigned numContacts);
+
+		void SiftUp(unsigned position);
+		void SiftDown(unsigned position);
+		void Swap(unsigned a, unsigned b);
+
 	};
 
+	using ParticleLinkPair = std::pair<ParticleHandle, ParticleHandle>;
+
 	class ParticleContactGenerator {
+	protected:
+		ThreadPool* threadPool = nullptr;
+
+	private:
+		mutable std::vector<std::vector<ParticleContact>> chunkContacts;
+
 	public:
+		// Broadphases are owned through this base, see CreateBroadphase
+		virtual ~ParticleContactGenerator() = default;
+
 		virtual unsigned AddContact(ParticleContact& contact, unsigned limit) const = 0;
+
+		// Writes the contacts to the front of contacts, at most its size, and returns how many
+		// were written. Generators producing many contacts in one pass override this one,
+		// the default hands the whole span to AddContact.
+		virtual unsigned AddContacts(std::span<ParticleContact> contacts) const {
+			return contacts.empty() ? 0 : AddContact(contacts.front(), static_cast<unsigned>(contacts.size()));
+		}
+
+		// Appends the particle pairs the generator keeps together, contact or not,
+		// so they always end up in the same island
+		virtual void CollectLinks(std::vector<ParticleLinkPair>& /*links*/) const {}
+
+		// Generators able to split their work run it on the pool, nullptr runs it serially
+		void SetThreadPool(ThreadPool* pool) { threadPool = pool; }
+
+	protected:
+		// Calls generate(i, contacts, limit) for every i of [0, count), which returns the
+		// number of contacts written. Runs in parallel with a thread pool, each chunk
+		// writing to its own buffer, but outputs the same contacts as a serial loop.
+		template<typename Generate>
+		unsigned GenerateInOrder(uint32_t count, ParticleContact* output, unsigned limit, Generate&& generate) const;
 	};
 
+	template<typename Generate>
+	unsigned ParticleContactGenerator::GenerateInOrder(uint32_t count, ParticleContact* output, unsigned limit, Generate&& generate) const {
+		constexpr uint32_t MIN_ITEMS_PER_CHUNK = 256;
+
+		if (not threadPool || threadPool->GetChunkCount(count, MIN_ITEMS_PER_CHUNK) == 1) {
+			unsigned used = 0;
+			for (uint32_t i = 0; i < count && used < limit; i++) {
+				used += generate(i, output + used, limit - used);
+			}
+			return used;
+		}
+
+		chunkContacts.resize(threadPool->GetChunkCount(count, MIN_ITEMS_PER_CHUNK));
+		std::vector<unsigned> chunkUsed(chunkContacts.size(), 0);
+
+		threadPool->ParallelForChunks(count, MIN_ITEMS_PER_CHUNK, [&](uint32_t chunk, uint32_t begin, uint32_t end, unsigned) {
+			std::vector<ParticleContact>& buffer = chunkContacts[chunk];
+			unsigned used = 0;
+
+			for (uint32_t i = begin; i < end && used < limit; i++) {
+				while (true) {
+					unsigned room = static_cast<unsigned>(buffer.size()) - used;
+					unsigned allowed = std::min(room, limit - used);
+					unsigned written = generate(i, buffer.data() + used, allowed);
+
+					// A full buffer may have cut the contacts of i short, grow it and start i over
+					if (written < allowed || allowed == limit - used) {
+						used += written;
+						break;
+					}
+					buffer.resize(buffer.size() * 2 + 64);
+				}
+			}
+
+			chunkUsed[chunk] = used;
+		});
+
+		// Concatenate in chunk order, like the serial loop
+		unsigned used = 0;
+		for (size_t chunk = 0; chunk < chunkContacts.size() && used < limit; chunk++) {
+			unsigned taken = std::min(chunkUsed[chunk], limit - used);
+			std::copy(chunkContacts[chunk].begin(), chunkContacts[chunk].begin() + taken, output + used);
+			used += taken;
+		}
+
+		return used;
+	}
+
 }
\ No newline at end of file
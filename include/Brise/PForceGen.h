@@ -1,30 +1,92 @@
 #pragma once
 
 #include <Brise/Particle.h>
+#include <Brise/PContact.h>
+#include <Brise/ThreadPool.h>
+
+#include <cstddef>
+#include <span>
 #include <vector>
 
 namespace Brise {
 
 	class ParticleForceGenerator {
 	public: 
-		virtual void UpdateForce(Particle* particle, float duration) = 0;
+		// Scenes own the generators they load through this base
+		virtual ~ParticleForceGenerator() = default;
+
+		virtual void UpdateForce(ParticleHandle particle, float duration) = 0;
+
+		// Applies the force to every listed particle, sorted by index.
+		// Calls UpdateForce for each of them by default, generators
+		// override it to process the whole batch in a single loop.
+		virtual void UpdateForces(ParticleStorage& particles, std::span<const uint32_t> indices, float duration);
+
+		// True if UpdateForces can run on disjoint sets of particles at the same time,
+		// false by default as custom generators may not
+		virtual bool IsThreadSafe() const { return false; }
+
+		// Particle the generator ties its registered particles to, so they share an island
+		// and wake together. None by default.
+		virtual ParticleHandle GetLinkedParticle() const { return {}; }
+
+		// Parameters saved with the world state, see World::SaveState.
+		// Generators changing over time write them as plain bytes, none by default.
+		// Particle handles are configuration, not state, and are left out.
+		virtual size_t GetStateSize() const { return 0; }
+		virtual void SaveState(std::byte* /*state*/) const {}
+		virtual void RestoreState(const std::byte* /*state*/) {}
 	};
 
+	// Registrations are batched by generator, generators of the same type being
+	// next to each other, and each batch is sorted by particle index. Every generator
+	// then gets one UpdateForces call per step, walking the columns in order.
 	class ParticleForceRegistry {
-	protected:
+	public:
 		struct ParticleForceRegistration {
-			Particle* particle;
+			ParticleHandle particle;
+			ParticleForceGenerator* fg;
+		};
+
+	protected:
+		// Particles of a generator, indices[first, first + count)
+		struct ParticleForceBatch {
 			ParticleForceGenerator* fg;
+			ParticleStorage* storage;
+			uint32_t first;
+			uint32_t count;
 		};
 
 		std::vector<ParticleForceRegistration> registry;
 
+		// Rebuilt from registry when it changes
+		std::vector<ParticleForceBatch> batches;
+		std::vector<uint32_t> indices;
+		std::vector<uint32_t> awakeIndices;
+		std::vector<ParticleForceGenerator*> generators; // Each generator once, in batch order
+		bool batchesDirty = false;
+
 	public:
-		void Add(Particle* particle, ParticleForceGenerator* fg);
-		void Remove(Particle* particle, ParticleForceGenerator* fg);
+		void Add(ParticleHandle particle, ParticleForceGenerator* fg);
+		void Remove(ParticleHandle particle, ParticleForceGenerator* fg);
 		void Clear();
+		// Drops the registrations of particles at index count and above, once they are removed
+		void RemoveParticlesFrom(uint32_t count);
+
+		// Thread safe generators split their batch over the pool
+		void UpdateForces(float duration, ThreadPool* pool = nullptr);
+
+		// Registered generators, each once, in the order their state is saved
+		std::span<ParticleForceGenerator* const> GetGenerators();
+
+		// Appends the registered particles tied to another one, see ParticleForceGenerator::GetLinkedParticle
+		void CollectLinks(std::vector<ParticleLinkPair>& links) const;
+
+		// Every registration, in the order they were added
+		std::span<const ParticleForceRegistration> GetRegistrations() const { return registry; }
 
-		void UpdateForces(float duration);
+	private:
+		void BuildBatches();
 	};
 
 	// USEFUL GENERATORS
@@ -37,20 +99,39 @@ namespace Brise {
 	public: 
 		ParticleGravity(const Vec2& gravityForce);
 
-		virtual void UpdateForce(Particle* particle, float duration) override;
+		Vec2 GetGravity() const { return gravity; }
+
+		virtual void UpdateForce(ParticleHandle particle, float duration) override;
+		virtual void UpdateForces(ParticleStorage& particles, std::span<const uint32_t> indices, float duration) override;
+		virtual bool IsThreadSafe() const override { return true; }
+
+		virtual size_t GetStateSize() const override;
+		virtual void SaveState(std::byte* state) const override;
+		virtual void RestoreState(const std::byte* state) override;
 	};
 
 	// Spring force generator
 	class ParticleSpring : public ParticleForceGenerator {
 	private:
-		Particle* other;
+		ParticleHandle other;
 		float springConstant;
 		float restLength;
 
 	public:
-		ParticleSpring(Particle* other, float springConstant, float restLength);
+		ParticleSpring(ParticleHandle other, float springConstant, float restLength);
 
-		virtual void UpdateForce(Particle* particle, float duration) override;
+		ParticleHandle GetOther() const { return other; }
+		float GetSpringConstant() const { return springConstant; }
+		float GetRestLength() const { return restLength; }
+
+		virtual void UpdateForce(ParticleHandle particle, float duration) override;
+		virtual void UpdateForces(ParticleStorage& particles, std::span<const uint32_t> indices, float duration) override;
+		virtual bool IsThreadSafe() const override { return true; }
+		virtual ParticleHandle GetLinkedParticle() const override { return other; }
+
+		virtual size_t GetStateSize() const override;
+		virtual void SaveState(std::byte* state) const override;
+		virtual void RestoreState(const std::byte* state) override;
 	};
 
 	// Anchored Spring force generator
@@ -63,20 +144,41 @@ namespace Brise {
 	public:
 		AnchoredParticleSpring(Vec2 anchor, float springConstant, float restLength);
 
-		virtual void UpdateForce(Particle* particle, float duration) override;
+		Vec2 GetAnchor() const { return anchor; }
+		float GetSpringConstant() const { return springConstant; }
+		float GetRestLength() const { return restLength; }
+
+		virtual void UpdateForce(ParticleHandle particle, float duration) override;
+		virtual void UpdateForces(ParticleStorage& particles, std::span<const uint32_t> indices, float duration) override;
+		virtual bool IsThreadSafe() const override { return true; }
+
+		virtual size_t GetStateSize() const override;
+		virtual void SaveState(std::byte* state) const override;
+		virtual void RestoreState(const std::byte* state) override;
 	};
 
 	// Bungee generator (spring that only pull objects)
 	class ParticleBungee : public ParticleForceGenerator {
 	private:
-		Particle* other;
+		ParticleHandle other;
 		float springConstant;
 		float restLength;
 
 	public:
-		ParticleBungee(Particle* other, float springConstant, float restLength);
+		ParticleBungee(ParticleHandle other, float springConstant, float restLength);
+
+		ParticleHandle GetOther() const { return other; }
+		float GetSpringConstant() const { return springConstant; }
+		float GetRestLength() const { return restLength; }
+
+		virtual void UpdateForce(ParticleHandle particle, float duration) override;
+		virtual void UpdateForces(ParticleStorage& particles, std::span<const uint32_t> indices, float duration) override;
+		virtual bool IsThreadSafe() const override { return true; }
+		virtual ParticleHandle GetLinkedParticle() const override { return other; }
 
-		virtual void UpdateForce(Particle* particle, float duration) override;
+		virtual size_t GetStateSize() const override;
+		virtual void SaveState(std::byte* state) const override;
+		virtual void RestoreState(const std::byte* state) override;
 	};
 
 	// Buoyancy generator (simulate a particle floating)
@@ -90,7 +192,18 @@ namespace Brise {
 	public:
 		ParticleBuoyancy(float maxDepth, float volume, float waterHeight, float liquidDensity = 1000.0f);
 
-		virtual void UpdateForce(Particle* particle, float duration) override;
+		float GetMaxDepth() const { return maxDepth; }
+		float GetVolume() const { return volume; }
+		float GetWaterHeight() const { return waterHeight; }
+		float GetLiquidDensity() const { return liquidDensity; }
+
+		virtual void UpdateForce(ParticleHandle particle, float duration) override;
+		virtual void UpdateForces(ParticleStorage& particles, std::span<const uint32_t> indices, float duration) override;
+		virtual bool IsThreadSafe() const override { return true; }
+
+		virtual size_t GetStateSize() const override;
+		virtual void SaveState(std::byte* state) const override;
+		virtual void RestoreState(const std::byte* state) override;
 	};
 
 }
\ No newline at end of file
@@ -2,17 +2,24 @@
 
 #include <Brise/PContact.h>
 
+#include <cstdint>
+#include <vector>
+
 namespace Brise {
     class ParticleLink : public ParticleContactGenerator
     {
     public:
-        Particle* particle[2];
+        ParticleHandle particle[2];
 
     protected:
         float CurrentLength() const;
 
+        // Links between sleeping or infinite mass particles have nothing to do
+        bool IsSimulated() const;
+
     public:
         virtual unsigned AddContact(ParticleContact& contact, unsigned limit) const = 0;
+        virtual void CollectLinks(std::vector<ParticleLinkPair>& links) const override;
     };
 
     // CABLES
@@ -37,4 +44,71 @@ namespace Brise {
         virtual unsigned AddContact(ParticleContact& contact, unsigned limit) const;
     };
 
-}
\ No newline at end of file
+    // LINK SETS
+
+    // Many links between particles of one storage, generating all their contacts in one call.
+    // Links are stored as flat arrays, measured in a single branch-free pass that runs over
+    // the thread pool if one is set, then the links under tension are written out in order.
+    class ParticleLinkSet : public ParticleContactGenerator
+    {
+    protected:
+        ParticleStorage* particles;
+
+        std::vector<uint32_t> particleA;
+        std::vector<uint32_t> particleB;
+        std::vector<float> length;      // Max length for cables, rest length for rods
+        std::vector<float> restitution;
+
+        // Filled by Measure for every link
+        mutable std::vector<float> normalX;
+        mutable std::vector<float> normalY;
+        mutable std::vector<float> penetration;
+        mutable std::vector<uint8_t> active;
+
+    public:
+        explicit ParticleLinkSet(ParticleStorage* particles);
+
+        virtual unsigned AddContact(ParticleContact& contact, unsigned limit) const override;
+        virtual unsigned AddContacts(std::span<ParticleContact> contacts) const override;
+        virtual void CollectLinks(std::vector<ParticleLinkPair>& links) const override;
+
+        // Removes a link, the following ones keep their order
+        void Remove(uint32_t link);
+        void Clear();
+
+        uint32_t GetLinkCount() const { return static_cast<uint32_t>(particleA.size()); }
+        ParticleHandle GetParticle(uint32_t link, unsigned end) const;
+        float GetLength(uint32_t link) const { return length[link]; }
+        float GetRestitution(uint32_t link) const { return restitution[link]; }
+        ParticleStorage* GetStorage() const { return particles; }
+
+    protected:
+        void Add(ParticleHandle a, ParticleHandle b, float linkLength, float linkRestitution);
+
+        // Fills the normal, penetration and active flag of the links [begin, end)
+        virtual void Measure(uint32_t begin, uint32_t end) const = 0;
+    };
+
+    class ParticleCableSet : public ParticleLinkSet
+    {
+    public:
+        using ParticleLinkSet::ParticleLinkSet;
+
+        void AddCable(ParticleHandle a, ParticleHandle b, float maxLength, float restitution);
+
+    protected:
+        virtual void Measure(uint32_t begin, uint32_t end) const override;
+    };
+
+    class ParticleRodSet : public ParticleLinkSet
+    {
+    public:
+        using ParticleLinkSet::ParticleLinkSet;
+
+        void AddRod(ParticleHandle a, ParticleHandle b, float length);
+
+    protected:
+        virtual void Measure(uint32_t begin, uint32_t end) const override;
+    };
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <Brise/Island.h>
+#include <Brise/PContact.h>
+#include <Brise/ThreadPool.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Brise {
+
+	// Velocity level contact solver.
+	// Every iteration applies an impulse on each contact, clamping the impulse
+	// accumulated over the step so contacts only ever push. Accumulated impulses
+	// are cached per particle pair and applied again at the start of the next
+	// step (warm starting), so resting contacts converge in a few iterations.
+	//
+	// Contacts are coloured so no two contacts of a colour share a dynamic particle, and
+	// solved colour by colour, each colour in parallel with a thread pool. The order only
+	// depends on the contacts, so results are the same for any thread count.
+	// With a thread pool and enough independent islands, islands are solved on different
+	// threads instead, each converging on its own. Whether that happens depends on the
+	// thread count, so results are only deterministic for a given count then.
+	class SequentialImpulseSolver {
+
+	public:
+		float baumgarte = 0.2f;             // Fraction of the penetration corrected per step
+		float penetrationSlop = 0.005f;     // Penetration left uncorrected, avoids jitter
+		float restitutionThreshold = 0.5f;  // Closing speed under which contacts don't bounce
+		bool warmStarting = true;
+
+	protected:
+		unsigned iterations;
+		unsigned iterationsUsed = 0;
+
+	public:
+		struct CachedImpulse {
+			uint64_t key;
+			Vec2 normal;
+			float impulse;
+		};
+
+	private:
+
+		// Previous step impulses, sorted by key
+		std::vector<CachedImpulse> cache;
+		std::vector<CachedImpulse> nextCache;
+
+		// Per contact data, valid during Solve
+		std::vector<float> effectiveMass;
+		std::vector<float> targetVelocity;
+		std::vector<float> accumulatedImpulse;
+
+		ThreadPool* threadPool = nullptr;
+
+		// Contact graph colouring, colour c holds contacts colorOrder[colorStart[c], colorStart[c + 1])
+		std::vector<uint32_t> contactColor;
+		std::vector<uint32_t> colorOrder;
+		std::vector<uint32_t> colorStart;
+		std::vector<uint64_t> particleColors; // Bit c set if the particle has a contact of colour c
+		std::vector<float> workerImpulse;     // Largest impulse applied by each worker
+		std::vector<unsigned> workerIterations;
+
+	public:
+		SequentialImpulseSolver(unsigned iterations = 8);
+
+		void SetIterations(unsigned iterations);
+		unsigned GetIterations() const { return iterations; }
+		unsigned GetIterationsUsed() const { return iterationsUsed; }
+
+		// islands, built over the same contacts, lets the solver run islands in parallel
+		void Solve(std::vector<ParticleContact>& contactArray, unsigned numContacts, float duration,
+			const ParticleIslands* islands = nullptr);
+
+		void ClearCache();
+
+		// Impulses kept for warm starting, saved with the world state
+		std::span<const CachedImpulse> GetCache() const { return cache; }
+		void SetCache(std::span<const CachedImpulse> impulses);
+
+		// Solves colour batches on the pool, nullptr solves every contact in order on the calling thread
+		void SetThreadPool(ThreadPool* pool);
+
+	private:
+		bool UseIslands(const ParticleIslands* islands, unsigned numContacts) const;
+		void SolveIslands(std::vector<ParticleContact>& contactArray, const ParticleIslands& islands, float duration);
+		void SolveColors(std::vector<ParticleContact>& contactArray, unsigned numContacts, float duration);
+
+		void ColorContacts(const std::vector<ParticleContact>& contactArray, unsigned numContacts);
+
+		template<typename Function>
+		void ForEachContact(Function&& function);
+
+		void PrepareContact(std::vector<ParticleContact>& contactArray, unsigned index, float duration);
+		// Returns the magnitude of the applied impulse
+		float SolveContact(ParticleContact& contact, unsigned index);
+		void ApplyImpulse(ParticleContact& contact, float impulse);
+
+		const CachedImpulse* FindCached(uint64_t key, Vec2 normal) const;
+	};
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <Brise/PContact.h>
+#include <Brise/Particle.h>
+#include <Brise/ThreadPool.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Brise {
+
+	// Springs and bungees between particles of a storage, evaluated together.
+	// Each spring is computed once and applies equal and opposite forces on its
+	// particles, unlike a ParticleSpring which has to be registered on both ends.
+	// Springs are stored as index pairs sorted by their lowest particle, in
+	// compressed rows: the springs starting at particle i are [rowStart[i], rowStart[i + 1]).
+	// A second index lists the springs ending at each particle, so every particle
+	// can gather its forces on its own, in parallel and always in the same order.
+	//
+	// Stiff networks can be integrated implicitly (backward Euler). The velocity change
+	// of the step solves (M - dt^2 K) dv = dt (f + dt K v), K being the spring Jacobian,
+	// with a matrix-free conjugate gradient preconditioned by the diagonal. Springs are
+	// linearised but the Jacobian is never assembled, it is applied spring by spring.
+	// The solution is handed to the integrator as the force giving that velocity change,
+	// so other forces have to be accumulated first, and semi-implicit Euler suits it best.
+	// Infinite mass and sleeping particles are held fixed, a spring to an infinite mass
+	// particle acts as an anchored spring.
+	class ParticleSpringNetwork {
+	public:
+		bool implicit = false;          // Backward Euler instead of applying the spring forces
+		unsigned maxIterations = 30;    // Conjugate gradient iteration budget per step
+		float tolerance = 0.001f;       // Residual norm, relative to the right hand side, ending the solve
+
+		struct Spring {
+			uint32_t a;
+			uint32_t b;
+			float springConstant;
+			float restLength;
+			bool bungee;
+		};
+
+	private:
+		ParticleStorage* particles;
+
+		std::vector<Spring> added; // In insertion order, compiled by Build
+		bool dirty = true; // Built on first use, even without springs
+
+		// Compiled springs, a < b
+		std::vector<uint32_t> rowStart;
+		std::vector<uint32_t> columnStart;   // Springs ending at particle i are columnSprings[columnStart[i], columnStart[i + 1])
+		std::vector<uint32_t> columnSprings;
+		std::vector<uint32_t> springA;
+		std::vector<uint32_t> springB;
+		std::vector<float> springConstant;
+		std::vector<float> restLength;
+		std::vector<float> minDisplacement; // 0 for bungees which only pull, -inf for springs
+
+		// Force of each spring on its first particle
+		std::vector<float> forceX;
+		std::vector<float> forceY;
+
+		// Implicit solve. Per spring, dt^2 times the negated force Jacobian, a symmetric 2x2
+		std::vector<float> stiffnessXX;
+		std::vector<float> stiffnessXY;
+		std::vector<float> stiffnessYY;
+
+		// Per particle, components of the system
+		std::vector<float> mass;        // 0 for fixed particles
+		std::vector<float> diagonalX;   // Jacobi preconditioner
+		std::vector<float> diagonalY;
+		std::vector<float> deltaVX;     // Solution
+		std::vector<float> deltaVY;
+		std::vector<float> residualX;
+		std::vector<float> residualY;
+		std::vector<float> directionX;
+		std::vector<float> directionY;
+		std::vector<float> productX;    // System applied to the direction
+		std::vector<float> productY;
+		std::vector<float> partialSums; // Per chunk, summed in order so dot products are deterministic
+		unsigned iterationsUsed = 0;
+
+	public:
+		explicit ParticleSpringNetwork(ParticleStorage* particles);
+
+		// Both particles must live in the network storage
+		void AddSpring(ParticleHandle a, ParticleHandle b, float springConstant, float restLength);
+		void AddBungee(ParticleHandle a, ParticleHandle b, float springConstant, float restLength);
+		void Clear();
+
+		// Compiles the added springs, done by UpdateForces if needed
+		void Build();
+
+		// Adds the spring forces to the particles force accumulators,
+		// springs and then particles being split over the pool if given.
+		// Implicit networks replace the accumulated force of their particles instead.
+		void UpdateForces(float duration, ThreadPool* pool = nullptr);
+
+		// Conjugate gradient iterations of the last implicit step
+		unsigned GetIterationsUsed() const { return iterationsUsed; }
+
+		// Appends the connected particle pairs, springs keep particles in the same island
+		void CollectLinks(std::vector<ParticleLinkPair>& links) const;
+
+		uint32_t GetSpringCount() const { return static_cast<uint32_t>(added.size()); }
+		// In the order they were added
+		std::span<const Spring> GetSprings() const { return added; }
+		ParticleStorage* GetStorage() const { return particles; }
+
+	private:
+		void ComputeForces(uint32_t begin, uint32_t end);
+		void GatherForces(uint32_t begin, uint32_t end);
+
+		// Sum of the springs values of particle i, those starting at it minus those ending at it
+		void SumSprings(uint32_t i, const std::vector<float>& valueX, const std::vector<float>& valueY, float& sumX, float& sumY) const;
+
+		void SolveImplicit(float duration, ThreadPool* pool);
+		void ComputeStiffness(uint32_t begin, uint32_t end, float duration);
+
+		// productX/Y = (M - dt^2 K) (inX, inY), fixed particles left out
+		void ApplySystem(const std::vector<float>& inX, const std::vector<float>& inY, ThreadPool* pool);
+
+		// Sum of term(i) over the particles
+		template<typename Term>
+		float Sum(ThreadPool* pool, Term&& term);
+
+		void Add(ParticleHandle a, ParticleHandle b, float springConstant, float restLength, bool bungee);
+	};
+
+}
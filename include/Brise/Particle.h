@@ -2,37 +2,161 @@
 
 #include <Brise/Vec2.h>
 
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 namespace Brise {
-	class Particle {
+
+	constexpr uint32_t INVALID_PARTICLE = std::numeric_limits<uint32_t>::max();
+
+	enum class IntegratorType; // See Integrator.h
+
+	// Structure-of-arrays particle storage.
+	// Each particle property lives in its own contiguous column, so passes
+	// only stream the columns they touch.
+	class ParticleStorage {
+
+	public:
+
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> velocityX;
+		std::vector<float> velocityY;
+		std::vector<float> accelerationX;
+		std::vector<float> accelerationY;
+		std::vector<float> forceAccumX;
+		std::vector<float> forceAccumY;
+		std::vector<float> inverseMass;
+		std::vector<float> damping;
+		std::vector<float> radius; // Collision radius, 0 if the particle doesn't collide
+
+		// 1 while the particle is simulated, 0 while it sleeps.
+		// Stored as floats so the batched kernels can load it as a mask.
+		std::vector<float> awake;
+		std::vector<uint32_t> restingSteps; // Consecutive steps its island spent at rest
+
+		// pow(damping, duration) cache, the first dampingFactorCount entries
+		// are valid for dampingFactorDuration
+		std::vector<float> dampingFactor;
+		float dampingFactorDuration = 0;
+		uint32_t dampingFactorCount = 0;
+
+		// Acceleration of the last step, used by velocity Verlet.
+		// Only the first previousAccelerationCount entries are valid.
+		std::vector<float> previousAccelerationX;
+		std::vector<float> previousAccelerationY;
+		uint32_t previousAccelerationCount = 0;
+
+		// Positions before the last step, to render between two steps
+		std::vector<float> previousPositionX;
+		std::vector<float> previousPositionY;
 
 	public:
 
-		Vec2 position;
-		Vec2 velocity;
-		Vec2 acceleration;
-		
+		uint32_t Add(Vec2 position, float mass, float damping);
+
+		void Reserve(size_t capacity);
+		void Clear();
+
+		uint32_t Size() const { return static_cast<uint32_t>(positionX.size()); }
+
+		Vec2 GetPosition(uint32_t index) const { return { positionX[index], positionY[index] }; }
+		Vec2 GetVelocity(uint32_t index) const { return { velocityX[index], velocityY[index] }; }
+		Vec2 GetAcceleration(uint32_t index) const { return { accelerationX[index], accelerationY[index] }; }
+
+		// Position alpha of the way from the previous step to the last one
+		Vec2 GetInterpolatedPosition(uint32_t index, float alpha) const {
+			return {
+				previousPositionX[index] + (positionX[index] - previousPositionX[index]) * alpha,
+				previousPositionY[index] + (positionY[index] - previousPositionY[index]) * alpha
+			};
+		}
+
+		// Copies the positions to the previous ones, called before each step
+		void SavePreviousPositions();
+
+		// Calls visit on every per particle column, always in the same order
+		template<typename Visit>
+		void ForEachColumn(Visit&& visit) {
+			visit(positionX); visit(positionY);
+			visit(velocityX); visit(velocityY);
+			visit(accelerationX); visit(accelerationY);
+			visit(forceAccumX); visit(forceAccumY);
+			visit(inverseMass); visit(damping); visit(radius);
+			visit(awake); visit(restingSteps);
+			visit(dampingFactor);
+			visit(previousAccelerationX); visit(previousAccelerationY);
+			visit(previousPositionX); visit(previousPositionY);
+		}
+
+		template<typename Visit>
+		void ForEachColumn(Visit&& visit) const {
+			const_cast<ParticleStorage*>(this)->ForEachColumn([&visit](const auto& column) { visit(column); });
+		}
+
+		// Awake particles with a finite mass, the only ones contacts and forces act on
+		bool IsSimulated(uint32_t index) const { return awake[index] != 0 && inverseMass[index] != 0; }
+
+	};
+
+	// Lightweight handle to a particle living in a ParticleStorage.
+	// Handles stay valid when the storage grows, as they hold an index
+	// rather than an address. A default constructed handle refers to no particle.
+	class ParticleHandle {
+
 	private:
 
-		float inverseMass;
-		float damping;
-		Vec2 forceAccum;
+		ParticleStorage* storage = nullptr;
+		uint32_t index = INVALID_PARTICLE;
 
 	public:
 
-		Particle(Vec2 _pos, float mass, float damping);
+		ParticleHandle() = default;
+		ParticleHandle(ParticleStorage* storage, uint32_t index)
+			: storage(storage), index(index) {
+		}
+
+		explicit operator bool() const { return storage != nullptr && index != INVALID_PARTICLE; }
+		bool operator==(const ParticleHandle& other) const = default;
 
+		uint32_t GetIndex() const { return index; }
+		ParticleStorage* GetStorage() const { return storage; }
+
+		Vec2 GetPosition() const { return storage->GetPosition(index); }
+		// Moves the particle without interpolating from where it was
+		void SetPosition(const Vec2& value);
+
+		Vec2 GetVelocity() const { return storage->GetVelocity(index); }
+		void SetVelocity(const Vec2& value) { storage->velocityX[index] = value.x; storage->velocityY[index] = value.y; }
+
+		Vec2 GetAcceleration() const { return storage->GetAcceleration(index); }
+		void SetAcceleration(const Vec2& value) { storage->accelerationX[index] = value.x; storage->accelerationY[index] = value.y; }
+
+		// Same kernels as IntegrateParticles, with the world's default Euler integrator
+		// or the given one. Pass World::GetIntegrator to match the world.
 		void Integrate(float dt);
+		void Integrate(float dt, IntegratorType type);
 
 		void AddForce(const Vec2& force);
 		void ClearAccumulator();
-		
+
 		void SetMass(float value);
 		void SetInfiniteMass();
 		float GetMass() const;
-		float GetInverseMass() const;
-		bool HasFiniteMass();
+		float GetInverseMass() const { return storage->inverseMass[index]; }
+		bool HasFiniteMass() const;
 
 		void SetDamping(float value);
+		float GetDamping() const { return storage->damping[index]; }
+
+		void SetRadius(float value) { storage->radius[index] = value; }
+		float GetRadius() const { return storage->radius[index]; }
+
+		// Sleeping particles are skipped by forces, integration and contact generation
+		// until woken by a contact, or by a call to SetAwake(true)
+		void SetAwake(bool value);
+		bool IsAwake() const { return storage->awake[index] != 0; }
 
 	};
-}
\ No newline at end of file
+}
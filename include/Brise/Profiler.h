@@ -0,0 +1,139 @@
+#pragma once
+
+#include <Brise/PContact.h>
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Set by the BRISE_ENABLE_PROFILER CMake option. At 0 the profiler keeps its interface
+// but records nothing, and steps don't read the clock.
+#ifndef BRISE_ENABLE_PROFILER
+	#define BRISE_ENABLE_PROFILER 1
+#endif
+
+namespace Brise {
+
+	constexpr uint32_t DEFAULT_PROFILER_WINDOW = 240;
+
+	// Seconds the last step spent in each of its phases, measured on a steady clock.
+	// All zero when the profiler is compiled out.
+	struct StepTimings {
+		double forces = 0;      // Force generators and spring networks
+		double integration = 0; // Integration, and the constraint solver
+		double contacts = 0;    // Contact generation
+		double islands = 0;     // Island building
+		double resolution = 0;  // Contact resolution
+		double sleeping = 0;    // Putting resting islands to sleep
+	};
+
+	// Last values of a statistic, in a ring buffer of window samples
+	class RollingStat {
+	private:
+		std::vector<double> samples;
+		uint32_t next = 0;  // Where the next sample goes
+		uint32_t count = 0;
+		double sum = 0;     // Of the samples in the window, recomputed each time the buffer wraps
+
+		mutable std::vector<double> sorted; // Scratch for percentiles
+
+	public:
+		explicit RollingStat(uint32_t window = DEFAULT_PROFILER_WINDOW);
+
+		void Add(double value);
+		void Clear();
+
+		// Clears the samples
+		void SetWindow(uint32_t window);
+		uint32_t GetWindow() const { return static_cast<uint32_t>(samples.size()); }
+		uint32_t GetCount() const { return count; }
+
+		// All zero without samples
+		double GetLast() const;
+		double GetAverage() const;
+		double GetMax() const;
+		// Nearest rank percentile of the window, p in [0, 1]
+		double GetPercentile(double p) const;
+	};
+
+	enum class ProfileStat {
+		// Seconds per step
+		Forces,
+		Integration,
+		ContactGeneration,
+		Islands,
+		Resolution,
+		Sleeping,
+		Step,
+
+		// Per step
+		Contacts,
+		ResolverIterations,
+		MaxPenetration,     // Deepest generated contact
+
+		// Per Update
+		StepsPerUpdate,
+
+		Count
+	};
+
+	// Rolling statistics of the last steps of a world, see World::GetProfiler
+	class WorldProfiler {
+	public:
+		static constexpr bool ENABLED = BRISE_ENABLE_PROFILER != 0;
+
+#if BRISE_ENABLE_PROFILER
+	private:
+		RollingStat stats[static_cast<size_t>(ProfileStat::Count)];
+		unsigned stepContacts = 0;
+		float stepPenetration = 0;
+
+	public:
+		// Samples kept by every statistic, clears them
+		void SetWindow(uint32_t window);
+		void Clear();
+
+		const RollingStat& Get(ProfileStat stat) const { return stats[static_cast<size_t>(stat)]; }
+
+		// Called by the world: the contacts once generated, then the step once done, and each Update
+		void RecordContacts(std::span<const ParticleContact> contacts);
+		void RecordStep(const StepTimings& timings, unsigned resolverIterations);
+		void RecordUpdate(unsigned steps);
+#else
+	public:
+		void SetWindow(uint32_t) {}
+		void Clear() {}
+
+		const RollingStat& Get(ProfileStat) const {
+			static const RollingStat empty(1);
+			return empty;
+		}
+
+		void RecordContacts(std::span<const ParticleContact>) {}
+		void RecordStep(const StepTimings&, unsigned) {}
+		void RecordUpdate(unsigned) {}
+#endif
+	};
+
+	// Splits a step in consecutive phases
+	class PhaseTimer {
+#if BRISE_ENABLE_PROFILER
+	private:
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	public:
+		// Seconds since the previous call, or since construction
+		double Lap() {
+			auto now = std::chrono::steady_clock::now();
+			double seconds = std::chrono::duration<double>(now - start).count();
+			start = now;
+			return seconds;
+		}
+#else
+	public:
+		double Lap() { return 0; }
+#endif
+	};
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Brise/PBroadphase.h>
+#include <Brise/PForceGen.h>
+#include <Brise/PLinks.h>
+#include <Brise/PSpringNetwork.h>
+#include <Brise/StaticGeometry.h>
+#include <Brise/World.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Brise {
+
+	constexpr uint32_t SCENE_VERSION = 1;
+
+	// Writes the world particles to a scene file, with what acts on them: spring networks,
+	// link sets, rods and cables, distance constraints, static geometry, broadphases, and the
+	// built-in force generators with their registrations. Custom generators and anything
+	// acting on another storage are left out. Returns false if the file couldn't be written.
+	bool ExportScene(const World& world, const char* path);
+
+	// Read-only view of a scene file, mapped in memory rather than read.
+	// A scene file is a header followed by flat arrays: particle columns, springs,
+	// links, geometry and generators, each stored as it is laid out in memory.
+	// Opening only checks the header and that every array lies within the file,
+	// nothing is parsed, and pages are only read from disk once touched.
+	// Files are in the byte order of the machine that wrote them.
+	class SceneFile {
+	private:
+		const std::byte* data = nullptr;
+		size_t size = 0;
+
+	public:
+		SceneFile() = default;
+		~SceneFile();
+
+		SceneFile(const SceneFile&) = delete;
+		SceneFile& operator=(const SceneFile&) = delete;
+
+		// Returns false if the file is missing, truncated, or of another version
+		bool Open(const char* path);
+		void Close();
+
+		bool IsOpen() const { return data != nullptr; }
+		uint32_t GetParticleCount() const;
+
+		// The whole mapped file
+		std::span<const std::byte> GetBytes() const { return { data, size }; }
+	};
+
+	// Objects a loaded scene added to a world. The world only keeps pointers to
+	// them, so the scene must outlive their use by the world.
+	class Scene {
+	private:
+		uint32_t firstParticle = 0;
+		uint32_t particleCount = 0;
+		bool loaded = false; // The world points into what the scene owns, so it can't be reloaded
+
+		std::vector<std::unique_ptr<ParticleSpringNetwork>> networks;
+		std::unique_ptr<ParticleCableSet> cables;
+		std::unique_ptr<ParticleRodSet> rods;
+		std::vector<std::unique_ptr<StaticGeometry>> geometries;
+		std::vector<std::unique_ptr<StaticContactGenerator>> geometryGenerators;
+		std::vector<std::unique_ptr<ParticleBroadphase>> broadphases;
+		std::vector<std::unique_ptr<ParticleForceGenerator>> forceGenerators;
+
+	public:
+		// Appends the scene particles to the world, copying each column in one go, then
+		// registers everything acting on them. Broadphases and static geometry act on every
+		// particle of the world, as they did in the exported one. A scene is loaded once,
+		// and has to live as long as the world steps.
+		// Returns false, leaving the world untouched, if the file refers to particles or
+		// records it doesn't hold
+		bool Load(World& world, const SceneFile& file);
+		// Returns false if the file couldn't be opened, or is invalid as above
+		bool Load(World& world, const char* path);
+
+		// The scene particles are [first, first + count) in the world
+		uint32_t GetFirstParticle() const { return firstParticle; }
+		uint32_t GetParticleCount() const { return particleCount; }
+
+		ParticleCableSet* GetCables() const { return cables.get(); }
+		ParticleRodSet* GetRods() const { return rods.get(); }
+		std::span<const std::unique_ptr<ParticleSpringNetwork>> GetSpringNetworks() const { return networks; }
+		std::span<const std::unique_ptr<StaticGeometry>> GetGeometries() const { return geometries; }
+	};
+
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <Brise/PContact.h>
+#include <Brise/Vec2.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Brise {
+
+	// Axis aligned bounding box
+	struct AABB {
+		Vec2 min;
+		Vec2 max;
+
+		bool Overlaps(const AABB& other) const {
+			return min.x <= other.max.x && other.min.x <= max.x
+				&& min.y <= other.max.y && other.min.y <= max.y;
+		}
+	};
+
+	// Immovable level geometry particles collide against.
+	// Half-planes are unbounded and tested one by one, segments and convex
+	// polygons are stored in a bounding volume hierarchy so a particle only
+	// visits the colliders around it.
+	class StaticGeometry {
+
+	public:
+		// Points p with Dot(p, normal) < offset are inside the plane
+		struct HalfPlane {
+			Vec2 normal;
+			float offset;
+		};
+
+		struct Segment {
+			Vec2 a;
+			Vec2 b;
+		};
+
+		// Vertices [first, first + count) of the vertex array, counter-clockwise
+		struct Polygon {
+			uint32_t first;
+			uint32_t count;
+		};
+
+	private:
+		enum class ColliderType : uint8_t {
+			Segment,
+			Polygon
+		};
+
+		struct Collider {
+			ColliderType type;
+			uint32_t index; // Into segments or polygons
+			AABB box;
+		};
+
+		// Leaves hold colliders [first, first + count), inner nodes have count == 0,
+		// their left child right after them and their right child at index first
+		struct Node {
+			AABB box;
+			uint32_t first;
+			uint32_t count;
+		};
+
+		std::vector<HalfPlane> planes;
+		std::vector<Segment> segments;
+		std::vector<Polygon> polygons;
+		std::vector<Vec2> vertices;
+		std::vector<Vec2> edgeNormals; // Outward normal of the edge starting at each vertex
+
+		std::vector<Collider> colliders;
+		std::vector<Node> nodes;
+
+	public:
+		// normal doesn't need to be normalized
+		void AddPlane(Vec2 normal, float offset);
+		void AddSegment(Vec2 a, Vec2 b);
+		// vertices must describe a convex polygon, in counter-clockwise order
+		void AddPolygon(std::span<const Vec2> polygonVertices);
+
+		// Builds the hierarchy, call it once every collider is added
+		void Build();
+
+		// Appends the contacts between a particle and the geometry, up to limit
+		unsigned Collide(ParticleHandle particle, float restitution, ParticleContact* contacts, unsigned limit) const;
+
+		const std::vector<HalfPlane>& GetPlanes() const { return planes; }
+		const std::vector<Segment>& GetSegments() const { return segments; }
+		const std::vector<Polygon>& GetPolygons() const { return polygons; }
+		const std::vector<Vec2>& GetVertices() const { return vertices; }
+
+	private:
+		uint32_t BuildNode(uint32_t first, uint32_t count);
+
+		bool CollideSegment(const Segment& segment, Vec2 position, float radius, ParticleContact& contact) const;
+		bool CollidePolygon(const Polygon& polygon, Vec2 position, float radius, ParticleContact& contact) const;
+	};
+
+	// Generates the contacts between every particle of a storage and static geometry
+	class StaticContactGenerator : public ParticleContactGenerator {
+	public:
+		float restitution = 0;
+
+	private:
+		ParticleStorage* particles;
+		const StaticGeometry* geometry;
+
+	public:
+		StaticContactGenerator(ParticleStorage* particles, const StaticGeometry* geometry);
+
+		virtual unsigned AddContact(ParticleContact& contact, unsigned limit) const override;
+
+		ParticleStorage* GetStorage() const { return particles; }
+		const StaticGeometry* GetGeometry() const { return geometry; }
+	};
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Brise {
+
+	// Work-stealing scheduler running data parallel loops.
+	// A loop is split in contiguous chunks handed out to per thread queues. Threads
+	// run their own chunks first, then steal from the others once they run dry.
+	// Chunk boundaries only depend on the range and the thread count, so work
+	// writing per chunk outputs stays deterministic whichever thread runs it.
+	// Loops can't be nested, nor started from several threads at once.
+	class ThreadPool {
+	public:
+		// Receives [begin, end) and the index of the thread running it
+		using RangeFunction = std::function<void(uint32_t begin, uint32_t end, unsigned worker)>;
+		// Same, with the index of the chunk
+		using ChunkFunction = std::function<void(uint32_t chunk, uint32_t begin, uint32_t end, unsigned worker)>;
+
+	private:
+		struct Task {
+			uint32_t chunk;
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		struct TaskQueue {
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		std::vector<std::thread> workers;
+		std::vector<std::unique_ptr<TaskQueue>> queues; // One per thread, the calling thread owns queue 0
+
+		const ChunkFunction* job = nullptr;
+		std::atomic<uint32_t> pendingTasks = 0;
+
+		std::mutex mutex;
+		std::condition_variable wake;
+		uint64_t generation = 0;
+		bool stopping = false;
+
+	public:
+		// threadCount includes the calling thread, 0 picks the hardware concurrency.
+		// pinThreads binds each worker thread to its own core, where supported.
+		explicit ThreadPool(unsigned threadCount = 0, bool pinThreads = false);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		unsigned GetThreadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+		// Number of chunks [0, count) is split in, chunks hold at least minChunk elements.
+		// Chunk c is [count * c / chunkCount, count * (c + 1) / chunkCount).
+		uint32_t GetChunkCount(uint32_t count, uint32_t minChunk) const;
+
+		// Runs function over [0, count) and returns once every chunk is done.
+		// A single chunk runs on the calling thread right away.
+		void ParallelFor(uint32_t count, uint32_t minChunk, const RangeFunction& function);
+		void ParallelForChunks(uint32_t count, uint32_t minChunk, const ChunkFunction& function);
+
+	private:
+		void WorkerLoop(unsigned worker);
+
+		// Runs a chunk from the thread's queue, or stolen from another, returns false if none was left
+		bool RunTask(unsigned worker);
+	};
+
+}
@@ -1,5 +1,6 @@
 #pragma once 
 
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -25,12 +26,30 @@ namespace Brise
 		const float& operator [](int i) const;
 
 		// Scalar multiplication
-		Vec2& operator /=(float s);
-		Vec2& operator *=(float s);
+		Vec2& operator /=(float s)
+		{
+			x /= s; y /= s;
+			return (*this);
+		}
+
+		Vec2& operator *=(float s)
+		{
+			x *= s; y *= s;
+			return (*this);
+		}
 
 		// Addition & substraction
-		Vec2& operator +=(const Vec2& v);
-		Vec2& operator -=(const Vec2& v);
+		Vec2& operator +=(const Vec2& v)
+		{
+			x += v.x; y += v.y;
+			return (*this);
+		}
+
+		Vec2& operator -=(const Vec2& v)
+		{
+			x -= v.x; y -= v.y;
+			return (*this);
+		}
 	};
 
 	// Vec2 operations functions
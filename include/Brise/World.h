@@ -1,52 +1,216 @@
 #pragma once
 
 #include <Brise/Particle.h>
+#include <Brise/Integrator.h>
+#include <Brise/Island.h>
 #include <Brise/PForceGen.h>
 #include <Brise/PContact.h>
+#include <Brise/PConstraints.h>
+#include <Brise/PSolver.h>
+#include <Brise/Profiler.h>
+#include <Brise/PSpringNetwork.h>
+#include <Brise/ThreadPool.h>
 #include <Brise/Vec2.h>
+#include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace Brise {
 
 	constexpr size_t DEFAULT_NUM_PARTICLES = 100;
+	constexpr unsigned DEFAULT_CONTACT_CAPACITY = 128;
+
+	// Contact buffer usage, updated every step
+	struct ContactStats {
+		unsigned generated = 0;     // Contacts generated during the last step
+		unsigned dropped = 0;       // Contacts past the maximum, left unresolved during the last step
+		unsigned regrowths = 0;     // Times the buffer grew during the last step
+		unsigned capacity = 0;      // Contacts the buffer holds without reallocating
+		unsigned highWaterMark = 0; // Most contacts generated in a single step
+	};
+
+	// What the last Update did to keep up with real time
+	struct UpdateStats {
+		unsigned steps = 0;          // Steps taken
+		float largestStep = 0;       // Longest step taken, above the fixed step when catching up
+		bool degraded = false;       // Took longer steps or fewer solver iterations to catch up
+		float droppedTime = 0;       // Simulated time given up, the world running behind real time
+		float totalDroppedTime = 0;  // Since the world was created
+		double elapsed = 0;          // Seconds spent in Update
+	};
+
+	// Particle positions blended between the last two steps, for rendering.
+	// Valid until the next Update.
+	class InterpolatedPositions {
+	private:
+		const ParticleStorage* storage;
+		float alpha;
+
+	public:
+		InterpolatedPositions(const ParticleStorage* storage, float alpha)
+			: storage(storage), alpha(alpha) {
+		}
+
+		Vec2 operator[](uint32_t index) const { return storage->GetInterpolatedPosition(index, alpha); }
+		Vec2 operator[](const ParticleHandle& particle) const { return (*this)[particle.GetIndex()]; }
+
+		uint32_t Size() const { return storage->Size(); }
+		float GetAlpha() const { return alpha; }
+	};
+
+	// Complete simulation state as plain bytes, see World::SaveState.
+	// Copying it is a single memcpy, so keeping a history for rollback is cheap.
+	struct WorldState {
+		std::vector<std::byte> data;
+	};
+
+	enum class ContactSolver {
+		Iterative,          // Resolves the worst contact first, see ParticleContactResolver
+		SequentialImpulse   // Accumulated impulses with warm starting, see SequentialImpulseSolver
+	};
 
 	class World {
 
 	public:
-		using ParticleContainer = std::vector<Particle>;
+		using ParticleContainer = ParticleStorage;
 		using ContactGenerators = std::vector<ParticleContactGenerator*>;
 		using ParticleContacts = std::vector<ParticleContact>;
+		using SpringNetworks = std::vector<ParticleSpringNetwork*>;
 
 		ParticleContacts contacts;
 		ParticleContactResolver resolver;
+		SequentialImpulseSolver impulseSolver;
+		ParticleIslands islands;
+		ParticleConstraintSolver constraints; // Rods and cables solved on positions, over the world particles
 		ContactGenerators contactGenerators;
+		SpringNetworks springNetworks;
 	
 	private:
 		ParticleContainer particles;
 		ParticleForceRegistry forceRegistry;
+		std::unique_ptr<ThreadPool> threadPool;
+		std::vector<ParticleLinkPair> links;
 		
-		unsigned maxContacts;
+		unsigned maxContacts = 0; // 0 lets the contact buffer grow as needed
+		ContactStats contactStats;
+		ParticleContacts droppedContacts; // Scratch to count the contacts past maxContacts
+		ContactSolver contactSolver = ContactSolver::Iterative;
+		IntegratorType integrator = IntegratorType::Euler;
+		bool sleeping = false;
 
 		Vec2 gravity; // World gravity acceleration
 
 		float fixedDt;
 		float accumulator = 0;
 
+		unsigned maxStepsPerUpdate = 0; // 0 for no limit
+		float timeBudget = 0;           // Seconds, 0 for no limit
+		unsigned maxStepScale = 1;      // Longest catch up step, in fixed steps
+		double stepCost = 0;            // Running average of the seconds a step takes
+		UpdateStats updateStats;
+		StepTimings stepTimings;
+		WorldProfiler profiler;
+
 	public:
 
-		// numParticles should be above the number of particles your world will contains
+		// numParticles is the storage reserved up front, handles stay valid if the world grows past it
 		explicit World(size_t numParticles = DEFAULT_NUM_PARTICLES, float fixedTimeStep = 1.0f / 120.0f);
 
-		void Update(float deltaTime);
+		// Handles, generators and the registry point into the world particles, so a world stays where it is
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+		World(World&&) = delete;
+		World& operator=(World&&) = delete;
+
+		// Removes every particle, with the force registrations, contact generators, spring networks
+		// and constraints acting on them, and the time left in the accumulator.
+		// Settings such as the fixed step, solver, integrator or thread count are kept.
+		void Clear();
 
-		Particle& AddParticule(Vec2 position, float mass, float damping);
+		// Runs as many fixed steps as the elapsed time calls for, within the limits below.
+		// Time that can't be caught up with is dropped and reported in GetUpdateStats.
+		void Update(float deltaTime);
+		float GetFixedTimeStep() const;
+
+		// Caps the steps of one Update, so a long frame doesn't cause even longer ones. 0 removes the cap.
+		void SetMaxStepsPerUpdate(unsigned max);
+		unsigned GetMaxStepsPerUpdate() const;
+
+		// Stops stepping once Update has run for this many seconds, measured on a steady clock.
+		// At least one step is always taken. 0 removes the budget.
+		void SetTimeBudget(float seconds);
+		float GetTimeBudget() const;
+
+		// When the pending steps don't fit in the limits, steps up to scale times the fixed step
+		// are taken, with half the impulse solver iterations, before dropping time. 1 never does.
+		void SetMaxStepScale(unsigned scale);
+		unsigned GetMaxStepScale() const;
+
+		const UpdateStats& GetUpdateStats() const;
+		const StepTimings& GetStepTimings() const;
+
+		// Rolling timings, contact counts, resolver iterations and penetration of the last steps,
+		// and the steps taken per Update. Empty when built without BRISE_ENABLE_PROFILER.
+		WorldProfiler& GetProfiler();
+		const WorldProfiler& GetProfiler() const;
+
+		// Fraction of a fixed step left in the accumulator after Update, in [0, 1).
+		// Rendering alpha of the way from the previous step to the last one hides the
+		// stutter of running the physics at a lower rate than the display.
+		float GetInterpolationAlpha() const;
+		InterpolatedPositions GetInterpolatedPositions() const;
+
+		// Writes every particle column, the accumulator, the impulse solver cache, the sleeping
+		// islands and the force generator parameters to state, reusing its memory.
+		// Restoring it puts the world back exactly, as long as the same generators are
+		// registered. Particles added since the save are removed, along with their force
+		// registrations. Contact generators, networks and constraints are configuration,
+		// and are not part of the state: links, springs and constraints referring to
+		// removed particles have to be removed by hand before restoring.
+		void SaveState(WorldState& state);
+		void RestoreState(const WorldState& state);
+
+		ParticleHandle AddParticule(Vec2 position, float mass, float damping);
+		ParticleHandle GetParticle(uint32_t index);
+		uint32_t GetParticleCount() const;
+		ParticleContainer& GetParticles();
 		const ParticleContainer& GetParticles() const;
 
-		void AddForceGenToRegistry(Particle* particle, ParticleForceGenerator* fg);
+		void AddForceGenToRegistry(ParticleHandle particle, ParticleForceGenerator* fg);
+		const ParticleForceRegistry& GetForceRegistry() const;
 		
 		void AddContactGenerator(ParticleContactGenerator* generator);
 		void RemoveContactGenerator(ParticleContactGenerator* generator);
 
+		// Networks must be built over the world particles
+		void AddSpringNetwork(ParticleSpringNetwork* network);
+		void RemoveSpringNetwork(ParticleSpringNetwork* network);
+
+		void SetContactSolver(ContactSolver solver);
+		ContactSolver GetContactSolver() const;
+
+		// Scheme moving the particles every step, the symplectic ones allow larger time steps
+		void SetIntegrator(IntegratorType type);
+		IntegratorType GetIntegrator() const;
+
+		// Threads running the steps, including the calling thread, on a work-stealing pool.
+		// Forces, integration, contact generation and the impulse solver are split over them.
+		// Results are deterministic for a given count, 0 runs everything serially.
+		// pinThreads binds each worker thread to its own core.
+		void SetThreadCount(unsigned count, bool pinThreads = false);
+		unsigned GetThreadCount() const;
+
+		// Puts resting islands to sleep, see ParticleIslands for the thresholds.
+		// Disabling it wakes every particle.
+		void SetSleeping(bool enabled);
+		bool IsSleeping() const;
+
+		// The contact buffer doubles whenever a step needs more room, and keeps its
+		// size afterwards. A non zero maximum caps it, extra contacts being dropped.
+		void SetMaxContacts(unsigned max);
+		unsigned GetMaxContacts() const;
+		const ContactStats& GetContactStats() const;
+
 	private:
 		void Init(size_t numParticles);
 		void Shutdown();
@@ -57,6 +221,9 @@ namespace Brise {
 		Vec2 GetGravity();
 
 		unsigned GenerateContacts();
+		bool GrowContacts();
+		unsigned CountContacts(const ParticleContactGenerator& generator);
+		void CollectLinks();
 	};
 
 }
\ No newline at end of file
@@ -55,12 +55,12 @@ namespace BriseSandbox {
 		void Render(AppContext* appstate) override {
 			SDL_SetRenderDrawColor(appstate->renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
 
-			const auto& particles = physicsWorld.GetParticles();
+			for (uint32_t i = 0; i < physicsWorld.GetParticleCount(); i++) {
+				Brise::ParticleHandle p = physicsWorld.GetParticle(i);
 
-			for (auto& p : particles) {
 				Utils::DrawCircle(
 					appstate->renderer,
-					p.position,
+					p.GetPosition(),
 					particleRadius
 				);
 
@@ -86,32 +86,32 @@ namespace BriseSandbox {
 		void SpawnBullet(BulletType type) {
 			Brise::Vec2 origin = { -10, 0 };
 			
-			Brise::Particle& p = physicsWorld.AddParticule(origin, 1, 0.999);
+			Brise::ParticleHandle p = physicsWorld.AddParticule(origin, 1, 0.999);
 
 			switch (type) {
 
 			case Pistol:
-				p.velocity = { 35, 0 }; // 35 m/s
-				p.acceleration = { 0, -1 };
+				p.SetVelocity({ 35, 0 }); // 35 m/s
+				p.SetAcceleration({ 0, -1 });
 				p.SetMass(2);
 				break;
 
 			case Artillery:
-				p.velocity = { 10, 15 }; // 50 m/s
-				p.acceleration = { 0, -20 };
+				p.SetVelocity({ 10, 15 }); // 50 m/s
+				p.SetAcceleration({ 0, -20 });
 				p.SetMass(200);
 				break;
 
 			case Fireball:
-				p.velocity = { 10, 0 }; // 10 m/s
-				p.acceleration = { 0, 0.6 };
+				p.SetVelocity({ 10, 0 }); // 10 m/s
+				p.SetAcceleration({ 0, 0.6 });
 				p.SetMass(1);
 				p.SetDamping(0.7);
 				break;
 
 			case Laser:
-				p.velocity = { 100, 0 }; // 100 m/s
-				p.acceleration = { 0, 0 };
+				p.SetVelocity({ 100, 0 }); // 100 m/s
+				p.SetAcceleration({ 0, 0 });
 				p.SetMass(0.1);
 				break;
 			}
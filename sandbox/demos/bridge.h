@@ -18,8 +18,8 @@ namespace BriseSandbox {
     private:
         Brise::World physicsWorld;
 
-        std::vector<Brise::Particle*> bridgeParticles;
-        std::vector<std::unique_ptr<Brise::ParticleCable>> cables;
+        std::vector<Brise::ParticleHandle> bridgeParticles;
+        std::unique_ptr<Brise::ParticleCableSet> cables;
 
         float particleRadius = 15.f;
         const int segmentCount = 10;
@@ -34,9 +34,8 @@ namespace BriseSandbox {
             if (event->type == SDL_EVENT_KEY_DOWN) {
                 if (event->key.scancode == SDL_SCANCODE_RETURN) {
 
-                    if (cables.size() > 2) {
-                        physicsWorld.RemoveContactGenerator(cables[2].get());
-                        cables.erase(cables.begin() + 2);
+                    if (cables->GetLinkCount() > 2) {
+                        cables->Remove(2);
                     }
                 }
             }
@@ -49,27 +48,27 @@ namespace BriseSandbox {
         void Render(AppContext* app) override {
             SDL_SetRenderDrawColor(app->renderer, 255, 255, 255, 255);
 
-            const auto& particles = physicsWorld.GetParticles();
+            for (uint32_t i = 0; i < physicsWorld.GetParticleCount(); i++) {
+                Brise::ParticleHandle p = physicsWorld.GetParticle(i);
 
-            for (auto& p : particles) {
-                Utils::DrawCircle(app->renderer, p.position, particleRadius);
+                Utils::DrawCircle(app->renderer, p.GetPosition(), particleRadius);
             }
 
-            for (size_t i = 0; i < cables.size(); ++i) {
+            for (uint32_t i = 0; i < cables->GetLinkCount(); ++i) {
                 Utils::DrawLine(
                     app->renderer,
-                    cables[i]->particle[0]->position,
-                    cables[i]->particle[1]->position
+                    cables->GetParticle(i, 0).GetPosition(),
+                    cables->GetParticle(i, 1).GetPosition()
                 );
             }
             Utils::DrawLine(
                 app->renderer,
-                bridgeParticles.front()->position,
+                bridgeParticles.front().GetPosition(),
                 {-15, 1}
             );
             Utils::DrawLine(
                 app->renderer,
-                bridgeParticles.back()->position,
+                bridgeParticles.back().GetPosition(),
                 {15, 1}
             );
             SDL_SetRenderScale(app->renderer, 1.5, 1.5);
@@ -86,27 +85,22 @@ namespace BriseSandbox {
             for (int i = 0; i < segmentCount; ++i) {
                 float x = startX + i * segmentLength;
 
-                Brise::Particle& p =
+                Brise::ParticleHandle p =
                     physicsWorld.AddParticule({ x, y }, 1.0f, 0.99f);
 
-                bridgeParticles.push_back(&p);
+                bridgeParticles.push_back(p);
             }
 
             // Fix endpoints (infinite mass)
-            bridgeParticles.front()->SetInfiniteMass();
-            bridgeParticles.back()->SetInfiniteMass();
+            bridgeParticles.front().SetInfiniteMass();
+            bridgeParticles.back().SetInfiniteMass();
 
-            // Create cables
+            // Create cables, all generated by a single set
+            cables = std::make_unique<Brise::ParticleCableSet>(&physicsWorld.GetParticles());
             for (int i = 0; i < segmentCount - 1; ++i) {
-                auto cable = std::make_unique<Brise::ParticleCable>();
-                cable->particle[0] = bridgeParticles[i];
-                cable->particle[1] = bridgeParticles[i + 1];
-                cable->maxLength = segmentLength;
-                cable->restitution = 0.2f;
-
-                physicsWorld.AddContactGenerator(cable.get());
-                cables.push_back(std::move(cable));
+                cables->AddCable(bridgeParticles[i], bridgeParticles[i + 1], segmentLength, 0.2f);
             }
+            physicsWorld.AddContactGenerator(cables.get());
         }
     };
 
@@ -37,12 +37,12 @@ namespace BriseSandbox {
 		void Render(AppContext* appstate) override {
 			SDL_SetRenderDrawColor(appstate->renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
 
-			const auto& particles = physicsWorld.GetParticles();
+			for (uint32_t i = 0; i < physicsWorld.GetParticleCount(); i++) {
+				Brise::ParticleHandle p = physicsWorld.GetParticle(i);
 
-			for (auto& p : particles) {
 				Utils::DrawCircle(
 					appstate->renderer,
-					p.position,
+					p.GetPosition(),
 					particleRadius
 				);
 
@@ -58,17 +58,17 @@ namespace BriseSandbox {
 
 	private:
 		void Init() {
-			Brise::Particle& p1 = physicsWorld.AddParticule({ -5, 3 }, 0.5f, 0.6);
+			Brise::ParticleHandle p1 = physicsWorld.AddParticule({ -5, 3 }, 0.5f, 0.6);
 			buoyancyGenerator = std::make_unique<Brise::ParticleBuoyancy>(0.25f, 0.006f, 1);
-			physicsWorld.AddForceGenToRegistry(&p1, buoyancyGenerator.get());
+			physicsWorld.AddForceGenToRegistry(p1, buoyancyGenerator.get());
 
-			Brise::Particle& p2 = physicsWorld.AddParticule({ 0, 3 }, 1.0f, 0.6);
+			Brise::ParticleHandle p2 = physicsWorld.AddParticule({ 0, 3 }, 1.0f, 0.6);
 			buoyancyGenerator2 = std::make_unique<Brise::ParticleBuoyancy>(0.25f, 0.02f, 1);
-			physicsWorld.AddForceGenToRegistry(&p2, buoyancyGenerator2.get());
+			physicsWorld.AddForceGenToRegistry(p2, buoyancyGenerator2.get());
 			
-			Brise::Particle& p3 = physicsWorld.AddParticule({ 3, 3 }, 5.0f, 0.6);
+			Brise::ParticleHandle p3 = physicsWorld.AddParticule({ 3, 3 }, 5.0f, 0.6);
 			buoyancyGenerator3 = std::make_unique<Brise::ParticleBuoyancy>(0.25f, 0.01f, 1);
-			physicsWorld.AddForceGenToRegistry(&p3, buoyancyGenerator3.get());
+			physicsWorld.AddForceGenToRegistry(p3, buoyancyGenerator3.get());
 		}
 		void Shutdown() {}
 
@@ -36,11 +36,11 @@ namespace BriseSandbox {
         {
             SDL_SetRenderDrawColor(app->renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
 
-            const auto& particles = physicsWorld.GetParticles();
-
-            for (auto& p : particles)
+            for (uint32_t i = 0; i < physicsWorld.GetParticleCount(); i++)
             {
-                Utils::DrawCircle(app->renderer, p.position, particleRadius);
+                Brise::ParticleHandle p = physicsWorld.GetParticle(i);
+
+                Utils::DrawCircle(app->renderer, p.GetPosition(), particleRadius);
                 Utils::DrawParticleInfos(app->renderer, p);
             }
 
@@ -48,8 +48,8 @@ namespace BriseSandbox {
             {
                 Utils::DrawLine(
                     app->renderer,
-                    cable->particle[0]->position,
-                    cable->particle[1]->position
+                    cable->particle[0].GetPosition(),
+                    cable->particle[1].GetPosition()
                 );
             }
         }
@@ -59,9 +59,9 @@ namespace BriseSandbox {
         void Init()
         {
             {
-                auto* p0 = &physicsWorld.AddParticule({ -5, 3 }, 1.0f, 0.99f);
-                p0->SetInfiniteMass();
-                auto* p1 = &physicsWorld.AddParticule({ -2, 0 }, 1.0f, 0.99f);
+                auto p0 = physicsWorld.AddParticule({ -5, 3 }, 1.0f, 0.99f);
+                p0.SetInfiniteMass();
+                auto p1 = physicsWorld.AddParticule({ -2, 0 }, 1.0f, 0.99f);
 
                 auto cable = std::make_unique<Brise::ParticleCable>();
                 cable->particle[0] = p0;
@@ -74,11 +74,11 @@ namespace BriseSandbox {
             }
 
             {
-                auto* p0 = &physicsWorld.AddParticule({ -5, -1}, 1.0f, 0.99f);
-                auto* p1 = &physicsWorld.AddParticule({ -2, -3 }, 1.0f, 0.99f);
-                p0->acceleration = { 0, 0 };
-                p0->velocity = { 3, 0 };
-                p1->acceleration = { 0, 0 };
+                auto p0 = physicsWorld.AddParticule({ -5, -1}, 1.0f, 0.99f);
+                auto p1 = physicsWorld.AddParticule({ -2, -3 }, 1.0f, 0.99f);
+                p0.SetAcceleration({ 0, 0 });
+                p0.SetVelocity({ 3, 0 });
+                p1.SetAcceleration({ 0, 0 });
 
                 auto cable = std::make_unique<Brise::ParticleCable>();
                 cable->particle[0] = p0;
@@ -91,10 +91,10 @@ namespace BriseSandbox {
             }
 
             {
-                auto* a = &physicsWorld.AddParticule({ 5, 3 }, 1.0f, 0.99f);
-                a->SetInfiniteMass();
-                auto* b = &physicsWorld.AddParticule({ 7, 1 }, 1.0f, 0.99f);
-                auto* c = &physicsWorld.AddParticule({ 9, 3 }, 1.0f, 0.99f);
+                auto a = physicsWorld.AddParticule({ 5, 3 }, 1.0f, 0.99f);
+                a.SetInfiniteMass();
+                auto b = physicsWorld.AddParticule({ 7, 1 }, 1.0f, 0.99f);
+                auto c = physicsWorld.AddParticule({ 9, 3 }, 1.0f, 0.99f);
 
                 auto cable1 = std::make_unique<Brise::ParticleCable>();
                 cable1->particle[0] = a;
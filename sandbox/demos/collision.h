@@ -8,6 +8,7 @@
 #include <demo.h>
 #include <Brise/World.h>
 #include <Brise/Vec2.h>
+#include <Brise/PBroadphase.h>
 
 namespace BriseSandbox {
 
@@ -34,8 +35,11 @@ namespace BriseSandbox {
 		float particleRadius = 25; // Particle radius in pixels for debug drawing
 		Brise::World physicsWorld;
 		
-		Brise::Particle* p0;
-		Brise::Particle* p1;
+		Brise::ParticleHandle p0;
+		Brise::ParticleHandle p1;
+
+		std::unique_ptr<Brise::GridBroadphase> broadphase;
+		float collisionRadius = 0.35f; // Particles collide under 0.7m
 
 		CollisionTest currentTest = CollisionTest::simpleCollision;
 
@@ -90,41 +94,17 @@ namespace BriseSandbox {
 
 		void Update(float deltaTime) override {
             physicsWorld.Update(deltaTime);
-
-			Brise::World::ParticleContainer particles = physicsWorld.GetParticles();
-			float distanceP0P1 = Brise::Magnitude(p0->position - p1->position);
-
-			if (distanceP0P1 < 0.7) {
-				Brise::ParticleContact contact;
-
-				contact.particle[0] = p0;
-				contact.particle[1] = p1;
-
-				Brise::Vec2 normal = Normalize(p0->position - p1->position);
-				contact.contactNormal = normal;
-
-				float penetration = 0.7f - distanceP0P1;
-				contact.penetration = penetration;
-
-                switch (currentTest) {
-                case zeroRestitution: contact.restitution = 0.0f; break;
-                case midRestitution:  contact.restitution = 0.5f; break;
-                default:              contact.restitution = 1.0f; break;
-                }
-
-				contact.Resolve(deltaTime);
-			}
 		}
 
 		void Render(AppContext* appstate) override {
 			SDL_SetRenderDrawColor(appstate->renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
 
-			const auto& particles = physicsWorld.GetParticles();
+			for (uint32_t i = 0; i < physicsWorld.GetParticleCount(); i++) {
+				Brise::ParticleHandle p = physicsWorld.GetParticle(i);
 
-			for (auto& p : particles) {
 				Utils::DrawCircle(
 					appstate->renderer,
-					p.position,
+					p.GetPosition(),
 					particleRadius
 				);
 
@@ -151,91 +131,103 @@ namespace BriseSandbox {
 			switch (currentTest) {
 
             case simpleCollision:
-                p0 = &physicsWorld.AddParticule({ -3, 0 }, 3, 0.99f);
-                p1 = &physicsWorld.AddParticule({ 3, 0 }, 3, 0.99f);
-                p0->velocity = { 2, 0 };
-                p1->velocity = { -2, 0 };
+                p0 = physicsWorld.AddParticule({ -3, 0 }, 3, 0.99f);
+                p1 = physicsWorld.AddParticule({ 3, 0 }, 3, 0.99f);
+                p0.SetVelocity({ 2, 0 });
+                p1.SetVelocity({ -2, 0 });
                 break;
 
 
             case nonLinearContact:
-                p0 = &physicsWorld.AddParticule({ -3, -1 }, 3, 0.99f);
-                p1 = &physicsWorld.AddParticule({ 3, 0 }, 3, 0.99f);
-                p0->velocity = { 2, 1 };
-                p1->velocity = { -2, 0 };
+                p0 = physicsWorld.AddParticule({ -3, -1 }, 3, 0.99f);
+                p1 = physicsWorld.AddParticule({ 3, 0 }, 3, 0.99f);
+                p0.SetVelocity({ 2, 1 });
+                p1.SetVelocity({ -2, 0 });
                 break;
 
 
             case differentSpeed:
-                p0 = &physicsWorld.AddParticule({ -3, 0 }, 3, 0.99f);
-                p1 = &physicsWorld.AddParticule({ 3, 0 }, 3, 0.99f);
-                p0->velocity = { 5, 0 };
-                p1->velocity = { -1, 0 };
+                p0 = physicsWorld.AddParticule({ -3, 0 }, 3, 0.99f);
+                p1 = physicsWorld.AddParticule({ 3, 0 }, 3, 0.99f);
+                p0.SetVelocity({ 5, 0 });
+                p1.SetVelocity({ -1, 0 });
                 break;
 
 
             case differentMasses:
-                p0 = &physicsWorld.AddParticule({ -3, 0 }, 1, 0.99f);
-                p1 = &physicsWorld.AddParticule({ 3, 0 }, 10, 0.99f);
-                p0->velocity = { 5, 0 };
-                p1->velocity = { 0, 0 };
+                p0 = physicsWorld.AddParticule({ -3, 0 }, 1, 0.99f);
+                p1 = physicsWorld.AddParticule({ 3, 0 }, 10, 0.99f);
+                p0.SetVelocity({ 5, 0 });
+                p1.SetVelocity({ 0, 0 });
                 break;
 
 
             case zeroRestitution:
-                p0 = &physicsWorld.AddParticule({ -3, 0 }, 3, 0.99f);
-                p1 = &physicsWorld.AddParticule({ 3, 0 }, 3, 0.99f);
-                p0->velocity = { 3, 0 };
-                p1->velocity = { -3, 0 };
+                p0 = physicsWorld.AddParticule({ -3, 0 }, 3, 0.99f);
+                p1 = physicsWorld.AddParticule({ 3, 0 }, 3, 0.99f);
+                p0.SetVelocity({ 3, 0 });
+                p1.SetVelocity({ -3, 0 });
                 break;
 
 
             case midRestitution:
-                p0 = &physicsWorld.AddParticule({ -3, 0 }, 3, 0.99f);
-                p1 = &physicsWorld.AddParticule({ 3, 0 }, 3, 0.99f);
-                p0->velocity = { 4, 0 };
-                p1->velocity = { -4, 0 };
+                p0 = physicsWorld.AddParticule({ -3, 0 }, 3, 0.99f);
+                p1 = physicsWorld.AddParticule({ 3, 0 }, 3, 0.99f);
+                p0.SetVelocity({ 4, 0 });
+                p1.SetVelocity({ -4, 0 });
                 break;
 
 
             case infiniteMass:
-                p0 = &physicsWorld.AddParticule({ -3, 0 }, 3, 0.99f);
-                p1 = &physicsWorld.AddParticule({ 3, 0 }, 1, 0.99f);
-                p1->SetInfiniteMass();
-                p0->velocity = { 5, 0 };
-                p1->velocity = { 0, 0 };
+                p0 = physicsWorld.AddParticule({ -3, 0 }, 3, 0.99f);
+                p1 = physicsWorld.AddParticule({ 3, 0 }, 1, 0.99f);
+                p1.SetInfiniteMass();
+                p0.SetVelocity({ 5, 0 });
+                p1.SetVelocity({ 0, 0 });
                 break;
 
 
             case interpenetration:
-                p0 = &physicsWorld.AddParticule({ -0.2f, 0 }, 3, 0.99f);
-                p1 = &physicsWorld.AddParticule({ 0.2f, 0 }, 3, 0.99f);
-                p0->velocity = { 0, 0 };
-                p1->velocity = { 0, 0 };
+                p0 = physicsWorld.AddParticule({ -0.2f, 0 }, 3, 0.99f);
+                p1 = physicsWorld.AddParticule({ 0.2f, 0 }, 3, 0.99f);
+                p0.SetVelocity({ 0, 0 });
+                p1.SetVelocity({ 0, 0 });
                 break;
 
 
             case stabilization:
-                p0 = &physicsWorld.AddParticule({ -1, 0 }, 3, 0.99f);
-                p1 = &physicsWorld.AddParticule({ 1, 0 }, 3, 0.99f);
-                p0->acceleration = { 0, 0 };
-                p1->acceleration = { 0, 0 };
-                p0->velocity = { 0.5f, 0 };
-                p1->velocity = { -0.5f, 0 };
+                p0 = physicsWorld.AddParticule({ -1, 0 }, 3, 0.99f);
+                p1 = physicsWorld.AddParticule({ 1, 0 }, 3, 0.99f);
+                p0.SetAcceleration({ 0, 0 });
+                p1.SetAcceleration({ 0, 0 });
+                p0.SetVelocity({ 0.5f, 0 });
+                p1.SetVelocity({ -0.5f, 0 });
                 break;
 			}
 
-			p0->acceleration = { 0, 0 };
-			p1->acceleration = { 0, 0 };
+			p0.SetAcceleration({ 0, 0 });
+			p1.SetAcceleration({ 0, 0 });
+
+			p0.SetRadius(collisionRadius);
+			p1.SetRadius(collisionRadius);
+
+			broadphase = std::make_unique<Brise::GridBroadphase>(&physicsWorld.GetParticles());
+
+            switch (currentTest) {
+            case zeroRestitution: broadphase->restitution = 0.0f; break;
+            case midRestitution:  broadphase->restitution = 0.5f; break;
+            default:              broadphase->restitution = 1.0f; break;
+            }
 
+			physicsWorld.AddContactGenerator(broadphase.get());
 		}
 
 		void Shutdown() {}
 
 		void SetupTest(CollisionTest test) {
-			physicsWorld = Brise::World();   
+			physicsWorld.Clear();
 			currentTest = test;
-			Init();                          
+			Init();
 		}
 
         const char* GetTestName() const
@@ -8,52 +8,24 @@
 #include <demo.h>
 #include <Brise/World.h>
 #include <Brise/Vec2.h>
-#include <Brise/PLinks.h>
+#include <Brise/StaticGeometry.h>
 
 namespace BriseSandbox {
-    class GroundContactGenerator : public Brise::ParticleContactGenerator {
-    public:
-        std::vector<Brise::Particle>* particles;
-        float groundY;
-
-        GroundContactGenerator(std::vector<Brise::Particle>* particles, float groundY)
-            : particles(particles), groundY(groundY) {
-        }
-
-        virtual unsigned AddContact(Brise::ParticleContact& contact, unsigned limit) const override {
-            unsigned used = 0;
-
-            for (auto& p : *particles) {
-                if (p.position.y < groundY) {
-                    contact.particle[0] = const_cast<Brise::Particle*>(&p);
-                    contact.particle[1] = nullptr;
-                    contact.contactNormal = { 0, 1 };
-                    contact.penetration = groundY - p.position.y;
-                    contact.restitution = 0.2f;
-                    return 1;
-                }
-            }
-
-            return 0;
-        }
-    };
-
-
     class CubeRodDemo : public Demo {
     public:
         CubeRodDemo() { Init(); }
         ~CubeRodDemo() {}
 
     private:
-        Brise::World physicsWorld;
+        Brise::World physicsWorld{ 100, 1.0f / 60.0f };
 
-        Brise::Particle* p0;
-        Brise::Particle* p1;
-        Brise::Particle* p2;
-        Brise::Particle* p3;
+        Brise::ParticleHandle p0;
+        Brise::ParticleHandle p1;
+        Brise::ParticleHandle p2;
+        Brise::ParticleHandle p3;
 
-        std::vector<std::unique_ptr<Brise::ParticleRod>> rods;
-        std::unique_ptr<GroundContactGenerator> ground;
+        Brise::StaticGeometry level;
+        std::unique_ptr<Brise::StaticContactGenerator> ground;
 
         float size = 1.0f;
         float particleRadius = 20.0f;
@@ -70,22 +42,23 @@ namespace BriseSandbox {
         }
 
         void Render(AppContext* app) override {
-            const auto& particles = physicsWorld.GetParticles();
+            // The physics runs at 60 Hz, draw between its last two steps
+            Brise::InterpolatedPositions positions = physicsWorld.GetInterpolatedPositions();
 
             SDL_SetRenderDrawColor(app->renderer, 255, 255, 255, 255);
 
-            for (auto& p : particles) {
-                Utils::DrawCircle(app->renderer, p.position, particleRadius);
+            for (uint32_t i = 0; i < positions.Size(); i++) {
+                Utils::DrawCircle(app->renderer, positions[i], particleRadius);
             }
 
             // Draw rods
-            Utils::DrawLine(app->renderer, p0->position, p1->position);
-            Utils::DrawLine(app->renderer, p1->position, p2->position);
-            Utils::DrawLine(app->renderer, p2->position, p3->position);
-            Utils::DrawLine(app->renderer, p3->position, p0->position);
+            Utils::DrawLine(app->renderer, positions[p0], positions[p1]);
+            Utils::DrawLine(app->renderer, positions[p1], positions[p2]);
+            Utils::DrawLine(app->renderer, positions[p2], positions[p3]);
+            Utils::DrawLine(app->renderer, positions[p3], positions[p0]);
 
-            Utils::DrawLine(app->renderer, p0->position, p2->position);
-            Utils::DrawLine(app->renderer, p1->position, p3->position);
+            Utils::DrawLine(app->renderer, positions[p0], positions[p2]);
+            Utils::DrawLine(app->renderer, positions[p1], positions[p3]);
 
             // Draw ground
             Utils::DrawLine(app->renderer, { -10,0 }, { 10,0 });
@@ -93,25 +66,19 @@ namespace BriseSandbox {
 
     private:
         void Init() {
-            physicsWorld = Brise::World(100, 1.0f / 60.0f);
-
             float startY = 3.0f;
 
-            p0 = &physicsWorld.AddParticule({ -size, startY }, 1.0f, 0.99f);
-            p1 = &physicsWorld.AddParticule({ size, startY }, 1.0f, 0.99f);
-            p2 = &physicsWorld.AddParticule({ size, startY - 2 * size }, 1.0f, 0.99f);
-            p3 = &physicsWorld.AddParticule({ -size, startY - 2 * size }, 1.0f, 0.99f);
+            p0 = physicsWorld.AddParticule({ -size, startY }, 1.0f, 0.99f);
+            p1 = physicsWorld.AddParticule({ size, startY }, 1.0f, 0.99f);
+            p2 = physicsWorld.AddParticule({ size, startY - 2 * size }, 1.0f, 0.99f);
+            p3 = physicsWorld.AddParticule({ -size, startY - 2 * size }, 1.0f, 0.99f);
 
             float edge = 2 * size;
             float diagonal = std::sqrt(2) * edge;
 
-            auto makeRod = [&](Brise::Particle* a, Brise::Particle* b, float length) {
-                auto rod = std::make_unique<Brise::ParticleRod>();
-                rod->particle[0] = a;
-                rod->particle[1] = b;
-                rod->length = length;
-                physicsWorld.AddContactGenerator(rod.get());
-                rods.push_back(std::move(rod));
+            // Rigid rods, kept by the position based solver
+            auto makeRod = [&](Brise::ParticleHandle a, Brise::ParticleHandle b, float length) {
+                physicsWorld.constraints.AddDistance(a, b, length);
                 };
 
             makeRod(p0, p1, edge);
@@ -122,10 +89,11 @@ namespace BriseSandbox {
             makeRod(p0, p2, diagonal);
             makeRod(p1, p3, diagonal);
 
-            ground = std::make_unique<GroundContactGenerator>(
-                const_cast<std::vector<Brise::Particle>*>(&physicsWorld.GetParticles()),
-                0.0f
-            );
+            level.AddPlane({ 0, 1 }, 0.0f);
+            level.Build();
+
+            ground = std::make_unique<Brise::StaticContactGenerator>(&physicsWorld.GetParticles(), &level);
+            ground->restitution = 0.2f;
 
             physicsWorld.AddContactGenerator(ground.get());
         }
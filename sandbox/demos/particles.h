@@ -47,12 +47,12 @@ namespace BriseSandbox {
 		void Render(AppContext* appstate) override {
 			SDL_SetRenderDrawColor(appstate->renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
 
-			const auto& particles = physicsWorld.GetParticles();
-			
-			for (auto& p : particles) {
+			for (uint32_t i = 0; i < physicsWorld.GetParticleCount(); i++) {
+				Brise::ParticleHandle p = physicsWorld.GetParticle(i);
+
 				Utils::DrawCircle(
 					appstate->renderer,
-					p.position,
+					p.GetPosition(),
 					particleRadius
 				);
 
@@ -5,6 +5,8 @@
 #include <utils.h>
 #include <Brise/World.h>
 #include <Brise/PContact.h>
+#include <Brise/PBroadphase.h>
+#include <Brise/StaticGeometry.h>
 #include <Brise/Vec2.h>
 
 namespace BriseSandbox {
@@ -13,9 +15,12 @@ namespace BriseSandbox {
     {
     private:
         Brise::World physicsWorld;
+        std::unique_ptr<Brise::GridBroadphase> broadphase;
+        Brise::StaticGeometry level;
+        std::unique_ptr<Brise::StaticContactGenerator> ground;
 
-        std::vector<Brise::Particle*> single;
-        std::vector<Brise::Particle*> stack;
+        std::vector<Brise::ParticleHandle> single;
+        std::vector<Brise::ParticleHandle> stack;
 
         float groundY = 0.0f;
         float radius = 0.33f;
@@ -33,27 +38,22 @@ namespace BriseSandbox {
         void Update(float deltaTime) override
         {
             physicsWorld.Update(deltaTime);
-
-            HandleGroundContacts(single, deltaTime);
-            HandleGroundContacts(stack, deltaTime);
-
-            HandleParticleContacts(stack, deltaTime);
         }
 
         void Render(AppContext* app) override
         {
             SDL_SetRenderDrawColor(app->renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
 
-            for (auto* p : single)
+            for (auto p : single)
             {
-                Utils::DrawCircle(app->renderer, p->position, 25);
-                Utils::DrawParticleInfos(app->renderer, *p);
+                Utils::DrawCircle(app->renderer, p.GetPosition(), 25);
+                Utils::DrawParticleInfos(app->renderer, p);
             }
 
-            for (auto* p : stack)
+            for (auto p : stack)
             {
-                Utils::DrawCircle(app->renderer, p->position, 25);
-                //Utils::DrawParticleInfos(app->renderer, *p);
+                Utils::DrawCircle(app->renderer, p.GetPosition(), 25);
+                //Utils::DrawParticleInfos(app->renderer, p);
             }
 
             Brise::Vec2 left = { -20, groundY };
@@ -70,75 +70,42 @@ namespace BriseSandbox {
 
             // -------- Left side : single particle --------
             single.push_back(
-                &physicsWorld.AddParticule({ -4, 5 }, 1.0f, 0.99f)
+                physicsWorld.AddParticule({ -4, 5 }, 1.0f, 0.99f)
             );
 
-            single[0]->velocity = { 0, 0 };
+            single[0].SetVelocity({ 0, 0 });
+            single[0].SetRadius(radius);
 
             // -------- Right side : stack --------
             stack.push_back(
-                &physicsWorld.AddParticule({ 4, 3 }, 1.0f, 0.99f)
+                physicsWorld.AddParticule({ 4, 3 }, 1.0f, 0.99f)
             );
             stack.push_back(
-                &physicsWorld.AddParticule({ 4, 4 }, 1.0f, 0.99f)
+                physicsWorld.AddParticule({ 4, 4 }, 1.0f, 0.99f)
             );
             stack.push_back(
-                &physicsWorld.AddParticule({ 4, 5 }, 1.0f, 0.99f)
+                physicsWorld.AddParticule({ 4, 5 }, 1.0f, 0.99f)
             );
 
-            for (auto* p : stack)
-                p->velocity = { 0, 0 };
-        }
-
-        void HandleGroundContacts(std::vector<Brise::Particle*>& particles, float dt)
-        {
-            for (auto* p : particles)
-            {
-                float penetration = (groundY + radius) - p->position.y;
-
-                if (penetration > 0.0f)
-                {
-                    Brise::ParticleContact contact;
-
-                    contact.particle[0] = p;
-                    contact.particle[1] = nullptr;
-                    contact.contactNormal = { 0, 1 };
-                    contact.penetration = penetration;
-                    contact.restitution = 0.0f;
-
-                    contact.Resolve(dt);
-                }
+            for (auto p : stack) {
+                p.SetVelocity({ 0, 0 });
+                p.SetRadius(radius);
             }
-        }
 
-        void HandleParticleContacts(std::vector<Brise::Particle*>& particles, float dt)
-        {
-            for (size_t i = 0; i < particles.size(); ++i)
-            {
-                for (size_t j = i + 1; j < particles.size(); ++j)
-                {
-                    auto* p0 = particles[i];
-                    auto* p1 = particles[j];
+            // Accumulated impulses keep the stack still once it settled
+            physicsWorld.SetContactSolver(Brise::ContactSolver::SequentialImpulse);
+            physicsWorld.SetSleeping(true);
 
-                    Brise::Vec2 delta = p0->position - p1->position;
-                    float distance = Brise::Magnitude(delta);
+            // Particle-particle contacts are handled by the world
+            broadphase = std::make_unique<Brise::GridBroadphase>(&physicsWorld.GetParticles());
+            physicsWorld.AddContactGenerator(broadphase.get());
 
-                    float penetration = (2.0f * radius) - distance;
+            // Ground
+            level.AddPlane({ 0, 1 }, groundY);
+            level.Build();
 
-                    if (penetration > 0.0f)
-                    {
-                        Brise::ParticleContact contact;
-
-                        contact.particle[0] = p0;
-                        contact.particle[1] = p1;
-                        contact.contactNormal = Normalize(delta);
-                        contact.penetration = penetration;
-                        contact.restitution = 0.0f;
-
-                        contact.Resolve(dt);
-                    }
-                }
-            }
+            ground = std::make_unique<Brise::StaticContactGenerator>(&physicsWorld.GetParticles(), &level);
+            physicsWorld.AddContactGenerator(ground.get());
         }
     };
 
@@ -37,11 +37,11 @@ namespace BriseSandbox {
         {
             SDL_SetRenderDrawColor(app->renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
 
-            const auto& particles = physicsWorld.GetParticles();
-
-            for (auto& p : particles)
+            for (uint32_t i = 0; i < physicsWorld.GetParticleCount(); i++)
             {
-                Utils::DrawCircle(app->renderer, p.position, particleRadius);
+                Brise::ParticleHandle p = physicsWorld.GetParticle(i);
+
+                Utils::DrawCircle(app->renderer, p.GetPosition(), particleRadius);
                 Utils::DrawParticleInfos(app->renderer, p);
             }
 
@@ -50,8 +50,8 @@ namespace BriseSandbox {
             {
                 Utils::DrawLine(
                     app->renderer,
-                    rod->particle[0]->position,
-                    rod->particle[1]->position
+                    rod->particle[0].GetPosition(),
+                    rod->particle[1].GetPosition()
                 );
             }
         }
@@ -61,11 +61,11 @@ namespace BriseSandbox {
         void Init()
         {
             {
-                auto* p0 = &physicsWorld.AddParticule({ -6, 3 }, 1.0f, 0.99f);
-                auto* p1 = &physicsWorld.AddParticule({ -7, 0 }, 1.0f, 0.99f);
-                p0->acceleration = { 0, 0 };
-                p1->acceleration = { 0, 0 };
-                p1->velocity = { 0, -1 };
+                auto p0 = physicsWorld.AddParticule({ -6, 3 }, 1.0f, 0.99f);
+                auto p1 = physicsWorld.AddParticule({ -7, 0 }, 1.0f, 0.99f);
+                p0.SetAcceleration({ 0, 0 });
+                p1.SetAcceleration({ 0, 0 });
+                p1.SetVelocity({ 0, -1 });
 
                 auto rod = std::make_unique<Brise::ParticleRod>();
                 rod->particle[0] = p0;
@@ -77,9 +77,9 @@ namespace BriseSandbox {
             }
 
             {
-                auto* p0 = &physicsWorld.AddParticule({ 0, 2 }, 1.0f, 0.99f);
-                p0->SetInfiniteMass();
-                auto* p1 = &physicsWorld.AddParticule({ 3, 2 }, 1.0f, 0.99f);
+                auto p0 = physicsWorld.AddParticule({ 0, 2 }, 1.0f, 0.99f);
+                p0.SetInfiniteMass();
+                auto p1 = physicsWorld.AddParticule({ 3, 2 }, 1.0f, 0.99f);
 
                 auto rod = std::make_unique<Brise::ParticleRod>();
                 rod->particle[0] = p0;
@@ -91,10 +91,10 @@ namespace BriseSandbox {
             }
 
             {
-                auto* a = &physicsWorld.AddParticule({ 6, 2 }, 0.5f, 0.99f);
-                a->SetInfiniteMass();                            
-                auto* b = &physicsWorld.AddParticule({ 8, 4 }, 0.5f, 0.99f);
-                auto* c = &physicsWorld.AddParticule({ 8, 7 }, 0.5f, 0.99f);
+                auto a = physicsWorld.AddParticule({ 6, 2 }, 0.5f, 0.99f);
+                a.SetInfiniteMass();                            
+                auto b = physicsWorld.AddParticule({ 8, 4 }, 0.5f, 0.99f);
+                auto c = physicsWorld.AddParticule({ 8, 7 }, 0.5f, 0.99f);
 
                 auto rod1 = std::make_unique<Brise::ParticleRod>();
                 rod1->particle[0] = a;
@@ -21,11 +21,8 @@ namespace BriseSandbox {
 
 		float particleRadius = 25; // Particle radius in pixels for debug drawing
 		Brise::World physicsWorld;
-		std::unique_ptr<Brise::ParticleSpring> springGenerator;
-		std::unique_ptr<Brise::ParticleSpring> springGenerator2;
+		std::unique_ptr<Brise::ParticleSpringNetwork> springs; // Two-way springs and bungees
 		std::unique_ptr<Brise::AnchoredParticleSpring> anchoredSpring;
-		std::unique_ptr<Brise::ParticleBungee> bungeeSpring;
-		std::unique_ptr<Brise::ParticleBungee> bungeeSpring2;
 
 	public:
 
@@ -39,21 +36,21 @@ namespace BriseSandbox {
 		void Render(AppContext* appstate) override {
 			SDL_SetRenderDrawColor(appstate->renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
 
-			const auto& particles = physicsWorld.GetParticles();
+			for (uint32_t i = 0; i < physicsWorld.GetParticleCount(); i++) {
+				Brise::ParticleHandle p = physicsWorld.GetParticle(i);
 
-			for (auto& p : particles) {
 				Utils::DrawCircle(
 					appstate->renderer,
-					p.position,
+					p.GetPosition(),
 					particleRadius
 				);
 
 				Utils::DrawParticleInfos(appstate->renderer, p);
 			}
 
-			Utils::DrawLine(appstate->renderer, particles[0].position, particles[1].position);
-			Utils::DrawLine(appstate->renderer, particles[2].position, {0, 3});
-			Utils::DrawLine(appstate->renderer, particles[3].position, particles[4].position);
+			Utils::DrawLine(appstate->renderer, physicsWorld.GetParticle(0).GetPosition(), physicsWorld.GetParticle(1).GetPosition());
+			Utils::DrawLine(appstate->renderer, physicsWorld.GetParticle(2).GetPosition(), {0, 3});
+			Utils::DrawLine(appstate->renderer, physicsWorld.GetParticle(3).GetPosition(), physicsWorld.GetParticle(4).GetPosition());
 		}
 
 		const char* GetName() const override {
@@ -62,29 +59,26 @@ namespace BriseSandbox {
 
 	private:
 		void Init() {
-			Brise::Particle& p1 = physicsWorld.AddParticule({ -5, 1 }, 3, 0.9);
-			Brise::Particle& p2 = physicsWorld.AddParticule({ -5, -2 }, 3, 0.9);
-			p1.acceleration = { 0, 0 };
-			p2.acceleration = { 0, 0 };
+			springs = std::make_unique<Brise::ParticleSpringNetwork>(&physicsWorld.GetParticles());
+			physicsWorld.AddSpringNetwork(springs.get());
+
+			Brise::ParticleHandle p1 = physicsWorld.AddParticule({ -5, 1 }, 3, 0.9);
+			Brise::ParticleHandle p2 = physicsWorld.AddParticule({ -5, -2 }, 3, 0.9);
+			p1.SetAcceleration({ 0, 0 });
+			p2.SetAcceleration({ 0, 0 });
 			
-			springGenerator = std::make_unique<Brise::ParticleSpring>(&p1, 5, 5);
-			springGenerator2 = std::make_unique<Brise::ParticleSpring>(&p2, 5, 5);
-			physicsWorld.AddForceGenToRegistry(&p2, springGenerator.get());
-			physicsWorld.AddForceGenToRegistry(&p1, springGenerator2.get());
+			springs->AddSpring(p1, p2, 5, 5);
 
-			Brise::Particle& p3 = physicsWorld.AddParticule({ -2, 0 }, 3, 0.9);
+			Brise::ParticleHandle p3 = physicsWorld.AddParticule({ -2, 0 }, 3, 0.9);
 			Brise::Vec2 anchor = { 0, 2 };
 			anchoredSpring = std::make_unique<Brise::AnchoredParticleSpring>(anchor, 50, 3);
-			physicsWorld.AddForceGenToRegistry(&p3, anchoredSpring.get());
-
-			Brise::Particle& p4 = physicsWorld.AddParticule({ 5, 5 }, 3, 0.6);
-			Brise::Particle& p5 = physicsWorld.AddParticule({ 5, -5 }, 3, 0.6);
-			p4.acceleration = { 0, 0 };
-			p5.acceleration = { 0, 0 };
-			bungeeSpring = std::make_unique<Brise::ParticleBungee>(&p4, 10, 0.1);
-			bungeeSpring2 = std::make_unique<Brise::ParticleBungee>(&p5, 10, 0.1);
-			physicsWorld.AddForceGenToRegistry(&p5, bungeeSpring.get());
-			physicsWorld.AddForceGenToRegistry(&p4, bungeeSpring2.get());
+			physicsWorld.AddForceGenToRegistry(p3, anchoredSpring.get());
+
+			Brise::ParticleHandle p4 = physicsWorld.AddParticule({ 5, 5 }, 3, 0.6);
+			Brise::ParticleHandle p5 = physicsWorld.AddParticule({ 5, -5 }, 3, 0.6);
+			p4.SetAcceleration({ 0, 0 });
+			p5.SetAcceleration({ 0, 0 });
+			springs->AddBungee(p4, p5, 10, 0.1);
 		}
 		void Shutdown() {}
 
@@ -178,17 +178,20 @@ namespace Utils {
 		SDL_SetRenderDrawColor(app->renderer, 255, 255, 255, 255);
 	}
 
-	void DrawParticleInfos(SDL_Renderer* renderer, const Brise::Particle& p) {
+	void DrawParticleInfos(SDL_Renderer* renderer, Brise::ParticleHandle p) {
 		char text[256];
-		Brise::Vec2 pScreenPos = Utils::WorldToScreenPosition(renderer, p.position);
+		Brise::Vec2 position = p.GetPosition();
+		Brise::Vec2 velocity = p.GetVelocity();
+		Brise::Vec2 acceleration = p.GetAcceleration();
+		Brise::Vec2 pScreenPos = Utils::WorldToScreenPosition(renderer, position);
 
 		// Draw position under particle
 		SDL_snprintf(
 			text,
 			sizeof(text),
 			"Pos (%.2f, y:%.2f)",
-			p.position.x,
-			p.position.y
+			position.x,
+			position.y
 		);
 
 		SDL_RenderDebugText(renderer, pScreenPos.x - 65, pScreenPos.y + 40, text);
@@ -198,8 +201,8 @@ namespace Utils {
 			text,
 			sizeof(text),
 			"Vel (%.2f, y:%.2f)",
-			p.velocity.x,
-			p.velocity.y
+			velocity.x,
+			velocity.y
 		);
 
 		SDL_RenderDebugText(renderer, pScreenPos.x - 65, pScreenPos.y + 50, text);
@@ -209,8 +212,8 @@ namespace Utils {
 			text,
 			sizeof(text),
 			"Acc (%.2f, y:%.2f)",
-			p.acceleration.x,
-			p.acceleration.y
+			acceleration.x,
+			acceleration.y
 		);
 
 		SDL_RenderDebugText(renderer, pScreenPos.x - 65, pScreenPos.y + 60, text);
@@ -225,12 +228,12 @@ namespace Utils {
 	bool MouseOverParticle(
 		SDL_Renderer* renderer,
 		float mouseX, float mouseY,
-		const Brise::Particle& p,
+		Brise::ParticleHandle p,
 		float particleRadius
 	) {
 		Brise::Vec2 mousePos = Utils::ScreenToWorld(renderer, { mouseX, mouseY });
 
-		if (Brise::DistanceSquared(mousePos, p.position) < powf(particleRadius / Utils::PIXELS_PER_METER, 2)) {
+		if (Brise::DistanceSquared(mousePos, p.GetPosition()) < powf(particleRadius / Utils::PIXELS_PER_METER, 2)) {
 			return true;
 		}
 
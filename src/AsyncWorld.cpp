@@ -0,0 +1,139 @@
+#include <Brise/AsyncWorld.h>
+#include <Brise/BriseAssert.h>
+
+#include <chrono>
+#include <utility>
+
+namespace Brise {
+
+	AsyncWorld::AsyncWorld(World& world)
+		: world(world) {
+	}
+
+	AsyncWorld::~AsyncWorld() {
+		Stop();
+	}
+
+	void AsyncWorld::Start() {
+		if (running.exchange(true)) return;
+
+		thread = std::thread(&AsyncWorld::Run, this);
+	}
+
+	void AsyncWorld::Stop() {
+		{
+			std::lock_guard lock(commandMutex);
+			if (not running.exchange(false)) return;
+		}
+		wake.notify_all();
+
+		thread.join();
+
+		// Nothing runs the world anymore, the caller owns it again
+		RunCommands();
+	}
+
+	void AsyncWorld::Submit(Command command) {
+		{
+			std::lock_guard lock(commandMutex);
+			commands.push_back(std::move(command));
+		}
+		wake.notify_all();
+	}
+
+	void AsyncWorld::AddParticle(Vec2 position, float mass, float damping, std::function<void(ParticleHandle)> onAdded) {
+		Submit([position, mass, damping, onAdded = std::move(onAdded)](World& world) {
+			ParticleHandle particle = world.AddParticule(position, mass, damping);
+			if (onAdded) onAdded(particle);
+		});
+	}
+
+	void AsyncWorld::ApplyImpulse(uint32_t particle, Vec2 impulse) {
+		Submit([particle, impulse](World& world) {
+			BR_ASSERT(particle < world.GetParticleCount());
+
+			ParticleHandle handle = world.GetParticle(particle);
+			handle.SetVelocity(handle.GetVelocity() + impulse * handle.GetInverseMass());
+			world.islands.WakeIsland(world.GetParticles(), particle);
+		});
+	}
+
+	void AsyncWorld::AddContactGenerator(ParticleContactGenerator* generator) {
+		Submit([generator](World& world) { world.AddContactGenerator(generator); });
+	}
+
+	void AsyncWorld::RemoveContactGenerator(ParticleContactGenerator* generator) {
+		Submit([generator](World& world) { world.RemoveContactGenerator(generator); });
+	}
+
+	void AsyncWorld::AddForceGenerator(uint32_t particle, ParticleForceGenerator* generator) {
+		Submit([particle, generator](World& world) { world.AddForceGenToRegistry(world.GetParticle(particle), generator); });
+	}
+
+	const WorldSnapshot& AsyncWorld::AcquireSnapshot() {
+		// Swap with the published snapshot only if it wasn't read yet
+		if (middle.load(std::memory_order_relaxed) & FRESH) {
+			front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+		}
+
+		return snapshots[front];
+	}
+
+	void AsyncWorld::Run() {
+		using Clock = std::chrono::steady_clock;
+
+		RunCommands();
+		Publish();
+
+		auto stepDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(world.GetFixedTimeStep()));
+		auto last = Clock::now();
+
+		while (running.load(std::memory_order_relaxed)) {
+			RunCommands();
+
+			auto now = Clock::now();
+			world.Update(std::chrono::duration<float>(now - last).count());
+			last = now;
+
+			steps += world.GetUpdateStats().steps;
+			Publish();
+
+			// Sleep until the next step is due, or a command or Stop comes in
+			std::unique_lock lock(commandMutex);
+			wake.wait_until(lock, last + stepDuration, [this] {
+				return not running.load(std::memory_order_relaxed) || not commands.empty();
+			});
+		}
+	}
+
+	void AsyncWorld::RunCommands() {
+		{
+			std::lock_guard lock(commandMutex);
+			std::swap(commands, runningCommands);
+		}
+
+		for (Command& command : runningCommands) {
+			command(world);
+		}
+		runningCommands.clear();
+	}
+
+	void AsyncWorld::Publish() {
+		const ParticleStorage& particles = world.GetParticles();
+		WorldSnapshot& snapshot = snapshots[back];
+
+		snapshot.positionX.assign(particles.positionX.begin(), particles.positionX.end());
+		snapshot.positionY.assign(particles.positionY.begin(), particles.positionY.end());
+		snapshot.velocityX.assign(particles.velocityX.begin(), particles.velocityX.end());
+		snapshot.velocityY.assign(particles.velocityY.begin(), particles.velocityY.end());
+		snapshot.previousPositionX.assign(particles.previousPositionX.begin(), particles.previousPositionX.end());
+		snapshot.previousPositionY.assign(particles.previousPositionY.begin(), particles.previousPositionY.end());
+		snapshot.steps = steps;
+		snapshot.accumulator = world.GetInterpolationAlpha() * world.GetFixedTimeStep();
+		snapshot.fixedTimeStep = world.GetFixedTimeStep();
+		snapshot.publishTime = std::chrono::steady_clock::now();
+
+		// The release makes the snapshot visible to the reader that swaps it in
+		back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+}
@@ -0,0 +1,367 @@
+#include <Brise/Integrator.h>
+#include <Brise/BriseAssert.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define BRISE_X86 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define BRISE_TARGET_AVX2
+	#else
+		#define BRISE_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#else
+	#define BRISE_X86 0
+#endif
+
+namespace Brise {
+
+	namespace {
+
+		SimdLevel activeLevel = DetectSimdLevel();
+
+		// Particles per parallel block, a multiple of every register width
+		constexpr uint32_t BLOCK_SIZE = 8;
+		constexpr uint32_t MIN_BLOCKS_PER_CHUNK = 512;
+
+		// Makes sure dampingFactor holds pow(damping, duration) for every particle.
+		// The power only depends on the step duration, so it is computed once per
+		// particle and reused for every step with the same duration.
+		void UpdateDampingFactors(ParticleStorage& particles, float duration) {
+			uint32_t first = particles.dampingFactorCount;
+			if (particles.dampingFactorDuration != duration) {
+				particles.dampingFactorDuration = duration;
+				first = 0;
+			}
+
+			for (uint32_t i = first; i < particles.Size(); i++) {
+				particles.dampingFactor[i] = std::pow(particles.damping[i], duration);
+			}
+
+			particles.dampingFactorCount = particles.Size();
+		}
+
+		// Velocity Verlet needs the acceleration of the previous step, particles
+		// integrated for the first time take their current one
+		void UpdatePreviousAccelerations(ParticleStorage& particles) {
+			for (uint32_t i = particles.previousAccelerationCount; i < particles.Size(); i++) {
+				particles.previousAccelerationX[i] = particles.accelerationX[i] + particles.forceAccumX[i] * particles.inverseMass[i];
+				particles.previousAccelerationY[i] = particles.accelerationY[i] + particles.forceAccumY[i] * particles.inverseMass[i];
+			}
+
+			particles.previousAccelerationCount = particles.Size();
+		}
+
+		// Integration of particle i with the given pow(damping, duration).
+		// Every kernel performs the same operations in the same order, so they
+		// give the same results.
+		template<IntegratorType Type>
+		void IntegrateOne(ParticleStorage& p, uint32_t i, float duration, float dampingFactor) {
+			const float halfDt = duration * 0.5f;
+			const float halfDtSquared = duration * duration * 0.5f;
+
+			float invMass = p.inverseMass[i];
+			float ax = p.accelerationX[i] + p.forceAccumX[i] * invMass;
+			float ay = p.accelerationY[i] + p.forceAccumY[i] * invMass;
+
+			if (invMass != 0 && p.awake[i] != 0) {
+				float px = p.positionX[i];
+				float py = p.positionY[i];
+				float vx = p.velocityX[i];
+				float vy = p.velocityY[i];
+
+				if constexpr (Type == IntegratorType::Euler) {
+					p.positionX[i] = px + vx * duration;
+					p.positionY[i] = py + vy * duration;
+					p.velocityX[i] = (vx + ax * duration) * dampingFactor;
+					p.velocityY[i] = (vy + ay * duration) * dampingFactor;
+				}
+				else if constexpr (Type == IntegratorType::SemiImplicitEuler) {
+					float newVx = (vx + ax * duration) * dampingFactor;
+					float newVy = (vy + ay * duration) * dampingFactor;
+					p.positionX[i] = px + newVx * duration;
+					p.positionY[i] = py + newVy * duration;
+					p.velocityX[i] = newVx;
+					p.velocityY[i] = newVy;
+				}
+				else if constexpr (Type == IntegratorType::PositionVerlet) {
+					// x' = x + (x - xPrevious) * damping + a * dt^2, with (x - xPrevious) / dt kept as the velocity
+					float newVx = vx * dampingFactor + ax * duration;
+					float newVy = vy * dampingFactor + ay * duration;
+					p.positionX[i] = px + newVx * duration;
+					p.positionY[i] = py + newVy * duration;
+					p.velocityX[i] = newVx;
+					p.velocityY[i] = newVy;
+				}
+				else {
+					// Finish the previous velocity update now that the acceleration is known
+					vx = vx + (ax - p.previousAccelerationX[i]) * halfDt;
+					vy = vy + (ay - p.previousAccelerationY[i]) * halfDt;
+					p.positionX[i] = px + vx * duration + ax * halfDtSquared;
+					p.positionY[i] = py + vy * duration + ay * halfDtSquared;
+					p.velocityX[i] = (vx + ax * duration) * dampingFactor;
+					p.velocityY[i] = (vy + ay * duration) * dampingFactor;
+				}
+			}
+
+			if constexpr (Type == IntegratorType::VelocityVerlet) {
+				p.previousAccelerationX[i] = ax;
+				p.previousAccelerationY[i] = ay;
+			}
+
+			p.forceAccumX[i] = 0;
+			p.forceAccumY[i] = 0;
+		}
+
+		// Integration of the [begin, end) range, one particle at a time
+		template<IntegratorType Type>
+		void IntegrateScalar(ParticleStorage& p, uint32_t begin, uint32_t end, float duration) {
+			for (uint32_t i = begin; i < end; i++) {
+				IntegrateOne<Type>(p, i, duration, p.dampingFactor[i]);
+			}
+		}
+
+#if BRISE_X86
+		template<IntegratorType Type>
+		uint32_t IntegrateSSE2(ParticleStorage& p, uint32_t begin, uint32_t end, float duration) {
+			const __m128 dt = _mm_set1_ps(duration);
+			const __m128 halfDt = _mm_set1_ps(duration * 0.5f);
+			const __m128 halfDtSquared = _mm_set1_ps(duration * duration * 0.5f);
+			const __m128 zero = _mm_setzero_ps();
+
+			uint32_t i = begin;
+			for (; i + 4 <= end; i += 4) {
+				__m128 invMass = _mm_loadu_ps(&p.inverseMass[i]);
+				__m128 dynamic = _mm_and_ps(_mm_cmpneq_ps(invMass, zero), _mm_cmpneq_ps(_mm_loadu_ps(&p.awake[i]), zero));
+				__m128 damp = _mm_loadu_ps(&p.dampingFactor[i]);
+
+				__m128 px = _mm_loadu_ps(&p.positionX[i]);
+				__m128 py = _mm_loadu_ps(&p.positionY[i]);
+				__m128 vx = _mm_loadu_ps(&p.velocityX[i]);
+				__m128 vy = _mm_loadu_ps(&p.velocityY[i]);
+
+				__m128 ax = _mm_add_ps(_mm_loadu_ps(&p.accelerationX[i]), _mm_mul_ps(_mm_loadu_ps(&p.forceAccumX[i]), invMass));
+				__m128 ay = _mm_add_ps(_mm_loadu_ps(&p.accelerationY[i]), _mm_mul_ps(_mm_loadu_ps(&p.forceAccumY[i]), invMass));
+
+				__m128 newPx, newPy, newVx, newVy;
+				if constexpr (Type == IntegratorType::Euler) {
+					newPx = _mm_add_ps(px, _mm_mul_ps(vx, dt));
+					newPy = _mm_add_ps(py, _mm_mul_ps(vy, dt));
+					newVx = _mm_mul_ps(_mm_add_ps(vx, _mm_mul_ps(ax, dt)), damp);
+					newVy = _mm_mul_ps(_mm_add_ps(vy, _mm_mul_ps(ay, dt)), damp);
+				}
+				else if constexpr (Type == IntegratorType::SemiImplicitEuler) {
+					newVx = _mm_mul_ps(_mm_add_ps(vx, _mm_mul_ps(ax, dt)), damp);
+					newVy = _mm_mul_ps(_mm_add_ps(vy, _mm_mul_ps(ay, dt)), damp);
+					newPx = _mm_add_ps(px, _mm_mul_ps(newVx, dt));
+					newPy = _mm_add_ps(py, _mm_mul_ps(newVy, dt));
+				}
+				else if constexpr (Type == IntegratorType::PositionVerlet) {
+					newVx = _mm_add_ps(_mm_mul_ps(vx, damp), _mm_mul_ps(ax, dt));
+					newVy = _mm_add_ps(_mm_mul_ps(vy, damp), _mm_mul_ps(ay, dt));
+					newPx = _mm_add_ps(px, _mm_mul_ps(newVx, dt));
+					newPy = _mm_add_ps(py, _mm_mul_ps(newVy, dt));
+				}
+				else {
+					__m128 cx = _mm_add_ps(vx, _mm_mul_ps(_mm_sub_ps(ax, _mm_loadu_ps(&p.previousAccelerationX[i])), halfDt));
+					__m128 cy = _mm_add_ps(vy, _mm_mul_ps(_mm_sub_ps(ay, _mm_loadu_ps(&p.previousAccelerationY[i])), halfDt));
+					newPx = _mm_add_ps(_mm_add_ps(px, _mm_mul_ps(cx, dt)), _mm_mul_ps(ax, halfDtSquared));
+					newPy = _mm_add_ps(_mm_add_ps(py, _mm_mul_ps(cy, dt)), _mm_mul_ps(ay, halfDtSquared));
+					newVx = _mm_mul_ps(_mm_add_ps(cx, _mm_mul_ps(ax, dt)), damp);
+					newVy = _mm_mul_ps(_mm_add_ps(cy, _mm_mul_ps(ay, dt)), damp);
+
+					_mm_storeu_ps(&p.previousAccelerationX[i], ax);
+					_mm_storeu_ps(&p.previousAccelerationY[i], ay);
+				}
+
+				// Keep infinite mass and sleeping particles as they are
+				_mm_storeu_ps(&p.positionX[i], _mm_or_ps(_mm_and_ps(dynamic, newPx), _mm_andnot_ps(dynamic, px)));
+				_mm_storeu_ps(&p.positionY[i], _mm_or_ps(_mm_and_ps(dynamic, newPy), _mm_andnot_ps(dynamic, py)));
+				_mm_storeu_ps(&p.velocityX[i], _mm_or_ps(_mm_and_ps(dynamic, newVx), _mm_andnot_ps(dynamic, vx)));
+				_mm_storeu_ps(&p.velocityY[i], _mm_or_ps(_mm_and_ps(dynamic, newVy), _mm_andnot_ps(dynamic, vy)));
+
+				_mm_storeu_ps(&p.forceAccumX[i], zero);
+				_mm_storeu_ps(&p.forceAccumY[i], zero);
+			}
+
+			return i;
+		}
+
+		template<IntegratorType Type>
+		BRISE_TARGET_AVX2
+		uint32_t IntegrateAVX2(ParticleStorage& p, uint32_t begin, uint32_t end, float duration) {
+			const __m256 dt = _mm256_set1_ps(duration);
+			const __m256 halfDt = _mm256_set1_ps(duration * 0.5f);
+			const __m256 halfDtSquared = _mm256_set1_ps(duration * duration * 0.5f);
+			const __m256 zero = _mm256_setzero_ps();
+
+			uint32_t i = begin;
+			for (; i + 8 <= end; i += 8) {
+				__m256 invMass = _mm256_loadu_ps(&p.inverseMass[i]);
+				__m256 dynamic = _mm256_and_ps(
+					_mm256_cmp_ps(invMass, zero, _CMP_NEQ_UQ),
+					_mm256_cmp_ps(_mm256_loadu_ps(&p.awake[i]), zero, _CMP_NEQ_UQ));
+				__m256 damp = _mm256_loadu_ps(&p.dampingFactor[i]);
+
+				__m256 px = _mm256_loadu_ps(&p.positionX[i]);
+				__m256 py = _mm256_loadu_ps(&p.positionY[i]);
+				__m256 vx = _mm256_loadu_ps(&p.velocityX[i]);
+				__m256 vy = _mm256_loadu_ps(&p.velocityY[i]);
+
+				__m256 ax = _mm256_add_ps(_mm256_loadu_ps(&p.accelerationX[i]), _mm256_mul_ps(_mm256_loadu_ps(&p.forceAccumX[i]), invMass));
+				__m256 ay = _mm256_add_ps(_mm256_loadu_ps(&p.accelerationY[i]), _mm256_mul_ps(_mm256_loadu_ps(&p.forceAccumY[i]), invMass));
+
+				__m256 newPx, newPy, newVx, newVy;
+				if constexpr (Type == IntegratorType::Euler) {
+					newPx = _mm256_add_ps(px, _mm256_mul_ps(vx, dt));
+					newPy = _mm256_add_ps(py, _mm256_mul_ps(vy, dt));
+					newVx = _mm256_mul_ps(_mm256_add_ps(vx, _mm256_mul_ps(ax, dt)), damp);
+					newVy = _mm256_mul_ps(_mm256_add_ps(vy, _mm256_mul_ps(ay, dt)), damp);
+				}
+				else if constexpr (Type == IntegratorType::SemiImplicitEuler) {
+					newVx = _mm256_mul_ps(_mm256_add_ps(vx, _mm256_mul_ps(ax, dt)), damp);
+					newVy = _mm256_mul_ps(_mm256_add_ps(vy, _mm256_mul_ps(ay, dt)), damp);
+					newPx = _mm256_add_ps(px, _mm256_mul_ps(newVx, dt));
+					newPy = _mm256_add_ps(py, _mm256_mul_ps(newVy, dt));
+				}
+				else if constexpr (Type == IntegratorType::PositionVerlet) {
+					newVx = _mm256_add_ps(_mm256_mul_ps(vx, damp), _mm256_mul_ps(ax, dt));
+					newVy = _mm256_add_ps(_mm256_mul_ps(vy, damp), _mm256_mul_ps(ay, dt));
+					newPx = _mm256_add_ps(px, _mm256_mul_ps(newVx, dt));
+					newPy = _mm256_add_ps(py, _mm256_mul_ps(newVy, dt));
+				}
+				else {
+					__m256 cx = _mm256_add_ps(vx, _mm256_mul_ps(_mm256_sub_ps(ax, _mm256_loadu_ps(&p.previousAccelerationX[i])), halfDt));
+					__m256 cy = _mm256_add_ps(vy, _mm256_mul_ps(_mm256_sub_ps(ay, _mm256_loadu_ps(&p.previousAccelerationY[i])), halfDt));
+					newPx = _mm256_add_ps(_mm256_add_ps(px, _mm256_mul_ps(cx, dt)), _mm256_mul_ps(ax, halfDtSquared));
+					newPy = _mm256_add_ps(_mm256_add_ps(py, _mm256_mul_ps(cy, dt)), _mm256_mul_ps(ay, halfDtSquared));
+					newVx = _mm256_mul_ps(_mm256_add_ps(cx, _mm256_mul_ps(ax, dt)), damp);
+					newVy = _mm256_mul_ps(_mm256_add_ps(cy, _mm256_mul_ps(ay, dt)), damp);
+
+					_mm256_storeu_ps(&p.previousAccelerationX[i], ax);
+					_mm256_storeu_ps(&p.previousAccelerationY[i], ay);
+				}
+
+				// Keep infinite mass and sleeping particles as they are
+				_mm256_storeu_ps(&p.positionX[i], _mm256_blendv_ps(px, newPx, dynamic));
+				_mm256_storeu_ps(&p.positionY[i], _mm256_blendv_ps(py, newPy, dynamic));
+				_mm256_storeu_ps(&p.velocityX[i], _mm256_blendv_ps(vx, newVx, dynamic));
+				_mm256_storeu_ps(&p.velocityY[i], _mm256_blendv_ps(vy, newVy, dynamic));
+
+				_mm256_storeu_ps(&p.forceAccumX[i], zero);
+				_mm256_storeu_ps(&p.forceAccumY[i], zero);
+			}
+
+			return i;
+		}
+#endif
+
+		template<IntegratorType Type>
+		void IntegrateBlocks(ParticleStorage& particles, float duration, ThreadPool* pool) {
+			uint32_t count = particles.Size();
+			auto integrate = [&particles, count, duration](uint32_t beginBlock, uint32_t endBlock, unsigned) {
+				uint32_t begin = beginBlock * BLOCK_SIZE;
+				uint32_t end = std::min(endBlock * BLOCK_SIZE, count);
+				uint32_t done = begin;
+
+#if BRISE_X86
+				switch (activeLevel) {
+				case SimdLevel::AVX2: done = IntegrateAVX2<Type>(particles, begin, end, duration); break;
+				case SimdLevel::SSE2: done = IntegrateSSE2<Type>(particles, begin, end, duration); break;
+				default: break;
+				}
+#endif
+
+				// Remaining particles that don't fill a whole register
+				IntegrateScalar<Type>(particles, done, end, duration);
+			};
+
+			uint32_t blocks = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			if (pool) pool->ParallelFor(blocks, MIN_BLOCKS_PER_CHUNK, integrate);
+			else integrate(0, blocks, 0);
+		}
+	}
+
+	SimdLevel DetectSimdLevel() {
+#if BRISE_X86 && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		bool sse2 = (info[3] & (1 << 26)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+
+		bool avx2 = false;
+		if (maxLeaf >= 7 && osxsave && avx) {
+			// The OS has to save the YMM registers on context switches
+			bool ymmEnabled = (_xgetbv(0) & 0x6) == 0x6;
+
+			__cpuidex(info, 7, 0);
+			avx2 = ymmEnabled && (info[1] & (1 << 5)) != 0;
+		}
+
+		if (avx2) return SimdLevel::AVX2;
+		if (sse2) return SimdLevel::SSE2;
+		return SimdLevel::Scalar;
+#elif BRISE_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+		if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+		return SimdLevel::Scalar;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}
+
+	SimdLevel GetSimdLevel() {
+		return activeLevel;
+	}
+
+	void SetSimdLevel(SimdLevel level) {
+		SimdLevel supported = DetectSimdLevel();
+		activeLevel = level < supported ? level : supported;
+	}
+
+	void IntegrateParticle(ParticleStorage& particles, uint32_t index, float duration, IntegratorType type) {
+		BR_ASSERT(duration > 0);
+
+		// The cached factor when it is valid, computed the same way otherwise
+		float dampingFactor = particles.dampingFactorDuration == duration && index < particles.dampingFactorCount
+			? particles.dampingFactor[index]
+			: std::pow(particles.damping[index], duration);
+
+		if (type == IntegratorType::VelocityVerlet && index >= particles.previousAccelerationCount) {
+			particles.previousAccelerationX[index] = particles.accelerationX[index] + particles.forceAccumX[index] * particles.inverseMass[index];
+			particles.previousAccelerationY[index] = particles.accelerationY[index] + particles.forceAccumY[index] * particles.inverseMass[index];
+		}
+
+		switch (type) {
+		case IntegratorType::Euler: IntegrateOne<IntegratorType::Euler>(particles, index, duration, dampingFactor); break;
+		case IntegratorType::SemiImplicitEuler: IntegrateOne<IntegratorType::SemiImplicitEuler>(particles, index, duration, dampingFactor); break;
+		case IntegratorType::PositionVerlet: IntegrateOne<IntegratorType::PositionVerlet>(particles, index, duration, dampingFactor); break;
+		case IntegratorType::VelocityVerlet: IntegrateOne<IntegratorType::VelocityVerlet>(particles, index, duration, dampingFactor); break;
+		}
+	}
+
+	void IntegrateParticles(ParticleStorage& particles, float duration, ThreadPool* pool, IntegratorType type) {
+		BR_ASSERT(duration > 0);
+
+		UpdateDampingFactors(particles, duration);
+
+		// Accelerations recorded by another integrator are stale
+		if (type == IntegratorType::VelocityVerlet) UpdatePreviousAccelerations(particles);
+		else particles.previousAccelerationCount = 0;
+
+		switch (type) {
+		case IntegratorType::Euler: IntegrateBlocks<IntegratorType::Euler>(particles, duration, pool); break;
+		case IntegratorType::SemiImplicitEuler: IntegrateBlocks<IntegratorType::SemiImplicitEuler>(particles, duration, pool); break;
+		case IntegratorType::PositionVerlet: IntegrateBlocks<IntegratorType::PositionVerlet>(particles, duration, pool); break;
+		case IntegratorType::VelocityVerlet: IntegrateBlocks<IntegratorType::VelocityVerlet>(particles, duration, pool); break;
+		}
+	}
+}
@@ -0,0 +1,235 @@
+#include <Brise/Island.h>
+
+#include <algorithm>
+
+namespace Brise {
+
+	namespace {
+		// Simulated particle of the contact the island is taken from, INVALID_PARTICLE if none
+		uint32_t SimulatedParticle(const ParticleStorage& storage, const ParticleContact& contact) {
+			for (const ParticleHandle& p : contact.particle) {
+				if (p && storage.IsSimulated(p.GetIndex())) return p.GetIndex();
+			}
+			return INVALID_PARTICLE;
+		}
+	}
+
+	uint32_t ParticleIslands::Find(uint32_t particle) {
+		// Path halving
+		while (parent[particle] != particle) {
+			parent[particle] = parent[parent[particle]];
+			particle = parent[particle];
+		}
+		return particle;
+	}
+
+	void ParticleIslands::Union(uint32_t a, uint32_t b) {
+		a = Find(a);
+		b = Find(b);
+
+		// The lowest index stays the root, so island order doesn't depend on the contact order
+		if (a < b) parent[b] = a;
+		else if (b < a) parent[a] = b;
+	}
+
+	void ParticleIslands::Touch(ParticleStorage& storage, const ParticleHandle& a, const ParticleHandle& b) {
+		if (not a || not b) return;
+
+		uint32_t ia = a.GetIndex();
+		uint32_t ib = b.GetIndex();
+
+		if (storage.IsSimulated(ia)) Wake(storage, ib);
+		if (storage.IsSimulated(ib)) Wake(storage, ia);
+	}
+
+	void ParticleIslands::Wake(ParticleStorage& storage, uint32_t particle) {
+		if (sleepGroup[particle] != INVALID_PARTICLE) {
+			wakeGroup[sleepGroup[particle]] = 1;
+		}
+		else if (storage.awake[particle] == 0) {
+			// Put to sleep by hand, it has no group
+			storage.awake[particle] = 1;
+			storage.restingSteps[particle] = 0;
+		}
+	}
+
+	void ParticleIslands::Build(ParticleStorage& storage, const std::vector<ParticleContact>& contactArray, unsigned numContacts,
+		std::span<const ParticleLinkPair> links) {
+		uint32_t count = storage.Size();
+
+		// Wake whole islands when something awake touches one of their particles
+		if (count < sleepGroup.size()) sleepGroup.clear(); // Storage was cleared
+		sleepGroup.resize(count, INVALID_PARTICLE);
+		nextAsleep.resize(count, INVALID_PARTICLE);
+		wakeGroup.assign(count, 0);
+
+		// A sleeper woken by hand wakes its island too
+		for (uint32_t i = 0; i < count; i++) {
+			if (sleepGroup[i] != INVALID_PARTICLE && storage.awake[i] != 0) wakeGroup[sleepGroup[i]] = 1;
+		}
+
+		for (unsigned i = 0; i < numContacts; i++) {
+			Touch(storage, contactArray[i].particle[0], contactArray[i].particle[1]);
+		}
+		for (const ParticleLinkPair& link : links) {
+			Touch(storage, link.first, link.second);
+		}
+
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t group = sleepGroup[i];
+			if (group == INVALID_PARTICLE) continue;
+
+			if (wakeGroup[group]) {
+				storage.awake[i] = 1;
+				storage.restingSteps[i] = 0;
+				sleepGroup[i] = INVALID_PARTICLE;
+			}
+		}
+
+		// Connect the simulated particles
+		parent.resize(count);
+		for (uint32_t i = 0; i < count; i++) {
+			parent[i] = i;
+		}
+
+		auto connect = [&](const ParticleHandle& a, const ParticleHandle& b) {
+			if (a && b && storage.IsSimulated(a.GetIndex()) && storage.IsSimulated(b.GetIndex())) {
+				Union(a.GetIndex(), b.GetIndex());
+			}
+		};
+
+		for (unsigned i = 0; i < numContacts; i++) {
+			connect(contactArray[i].particle[0], contactArray[i].particle[1]);
+		}
+		for (const ParticleLinkPair& link : links) {
+			connect(link.first, link.second);
+		}
+
+		// Number islands by their lowest particle, roots come first in their island
+		islandOf.assign(count, INVALID_PARTICLE);
+		particleStart.assign(1, 0);
+
+		for (uint32_t i = 0; i < count; i++) {
+			if (not storage.IsSimulated(i)) continue;
+
+			uint32_t root = Find(i);
+			if (root == i) {
+				islandOf[i] = static_cast<uint32_t>(particleStart.size()) - 1;
+				particleStart.push_back(0);
+			}
+			else {
+				islandOf[i] = islandOf[root];
+			}
+			particleStart[islandOf[i] + 1]++;
+		}
+
+		uint32_t islandCount = GetIslandCount();
+		contactStart.assign(islandCount + 1, 0);
+
+		for (unsigned i = 0; i < numContacts; i++) {
+			uint32_t p = SimulatedParticle(storage, contactArray[i]);
+			if (p != INVALID_PARTICLE) contactStart[islandOf[p] + 1]++;
+		}
+
+		// Counting sorts, islands keep particles and contacts in index order
+		for (uint32_t island = 0; island < islandCount; island++) {
+			particleStart[island + 1] += particleStart[island];
+			contactStart[island + 1] += contactStart[island];
+		}
+
+		particles.resize(particleStart[islandCount]);
+		contacts.resize(contactStart[islandCount]);
+
+		std::vector<uint32_t>& next = parent; // Not needed anymore, reused as fill cursors
+		std::copy(particleStart.begin(), particleStart.end() - 1, next.begin());
+		for (uint32_t i = 0; i < count; i++) {
+			if (islandOf[i] != INVALID_PARTICLE) particles[next[islandOf[i]]++] = i;
+		}
+
+		std::copy(contactStart.begin(), contactStart.end() - 1, next.begin());
+		for (unsigned i = 0; i < numContacts; i++) {
+			uint32_t p = SimulatedParticle(storage, contactArray[i]);
+			if (p != INVALID_PARTICLE) contacts[next[islandOf[p]]++] = i;
+		}
+	}
+
+	void ParticleIslands::UpdateSleep(ParticleStorage& storage) {
+		for (uint32_t island = 0; island < GetIslandCount(); island++) {
+			std::span<const uint32_t> members = GetParticles(island);
+
+			float energy = 0;
+			for (uint32_t i : members) {
+				float vx = storage.velocityX[i];
+				float vy = storage.velocityY[i];
+				energy += 0.5f * (vx * vx + vy * vy) / storage.inverseMass[i];
+			}
+
+			bool resting = energy < sleepEnergy * members.size();
+
+			uint32_t minSteps = UINT32_MAX;
+			for (uint32_t i : members) {
+				storage.restingSteps[i] = resting ? storage.restingSteps[i] + 1 : 0;
+				minSteps = std::min(minSteps, storage.restingSteps[i]);
+			}
+
+			if (minSteps < sleepSteps) continue;
+
+			for (size_t m = 0; m < members.size(); m++) {
+				uint32_t i = members[m];
+				storage.awake[i] = 0;
+				storage.restingSteps[i] = 0;
+				storage.velocityX[i] = 0;
+				storage.velocityY[i] = 0;
+				sleepGroup[i] = members[0];
+				nextAsleep[i] = m + 1 < members.size() ? members[m + 1] : INVALID_PARTICLE;
+			}
+		}
+	}
+
+	void ParticleIslands::WakeAll(ParticleStorage& storage) {
+		std::fill(storage.awake.begin(), storage.awake.end(), 1.0f);
+		std::fill(storage.restingSteps.begin(), storage.restingSteps.end(), 0);
+		std::fill(sleepGroup.begin(), sleepGroup.end(), INVALID_PARTICLE);
+	}
+
+	void ParticleIslands::SetSleepGroups(std::span<const uint32_t> groups) {
+		sleepGroup.assign(groups.begin(), groups.end());
+
+		// Members were listed in index order, the group's first particle leading
+		nextAsleep.assign(sleepGroup.size(), INVALID_PARTICLE);
+		std::vector<uint32_t> last(sleepGroup.size(), INVALID_PARTICLE);
+		for (uint32_t i = 0; i < sleepGroup.size(); i++) {
+			uint32_t group = sleepGroup[i];
+			if (group == INVALID_PARTICLE) continue;
+
+			if (last[group] != INVALID_PARTICLE) nextAsleep[last[group]] = i;
+			last[group] = i;
+		}
+	}
+
+	void ParticleIslands::WakeIsland(ParticleStorage& storage, uint32_t particle) {
+		uint32_t group = particle < sleepGroup.size() ? sleepGroup[particle] : INVALID_PARTICLE;
+
+		if (group != INVALID_PARTICLE) {
+			// The group is named after its first particle, the head of its list
+			for (uint32_t i = group; i != INVALID_PARTICLE; i = nextAsleep[i]) {
+				storage.awake[i] = 1;
+				storage.restingSteps[i] = 0;
+				sleepGroup[i] = INVALID_PARTICLE;
+			}
+		}
+		else if (storage.awake[particle] == 0) {
+			// Put to sleep by hand, it has no group
+			storage.awake[particle] = 1;
+			storage.restingSteps[particle] = 0;
+		}
+	}
+
+	std::span<const uint32_t> ParticleIslands::GetParticles(uint32_t island) const {
+		return std::span<const uint32_t>(particles).subspan(particleStart[island], particleStart[island + 1] - particleStart[island]);
+	}
+
+	std::span<const uint32_t> ParticleIslands::GetContacts(uint32_t island) const {
+		return std::span<const uint32_t>(contacts).subspan(contactStart[island], contactStart[island + 1] - contactStart[island]);
+	}
+}
@@ -0,0 +1,263 @@
+#include <Brise/PBroadphase.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace Brise {
+
+	// BROADPHASE
+
+	ParticleBroadphase::ParticleBroadphase(ParticleStorage* particles)
+		: particles(particles) {
+	}
+
+	bool ParticleBroadphase::Collide(uint32_t a, uint32_t b, ParticleContact& contact) const {
+		const ParticleStorage& p = *particles;
+
+		// Nothing to resolve unless one of them moves, sleeping particles
+		// are only woken by awake ones
+		if (not p.IsSimulated(a) && not p.IsSimulated(b)) return false;
+
+		float dx = p.positionX[a] - p.positionX[b];
+		float dy = p.positionY[a] - p.positionY[b];
+		float radii = p.radius[a] + p.radius[b];
+
+		float distanceSquared = dx * dx + dy * dy;
+		if (distanceSquared >= radii * radii) return false;
+
+		float distance = std::sqrt(distanceSquared);
+
+		contact.particle[0] = ParticleHandle(particles, a);
+		contact.particle[1] = ParticleHandle(particles, b);
+
+		// Normal pushes a away from b, pick an arbitrary one if they are at the same place
+		if (distance > 0) {
+			contact.contactNormal = { dx / distance, dy / distance };
+		}
+		else {
+			contact.contactNormal = { 0, 1 };
+		}
+
+		contact.penetration = radii - distance;
+		contact.restitution = restitution;
+
+		return true;
+	}
+
+	// GRID
+
+	GridBroadphase::GridBroadphase(ParticleStorage* particles, float cellSize)
+		: ParticleBroadphase(particles), cellSize(cellSize) {
+	}
+
+	uint32_t GridBroadphase::Bucket(int32_t x, int32_t y) const {
+		uint32_t hash = (static_cast<uint32_t>(x) * 73856093u) ^ (static_cast<uint32_t>(y) * 19349663u);
+		return hash & bucketMask;
+	}
+
+	/// <summary>
+	/// Buckets every colliding particle by cell with a counting sort.
+	/// </summary>
+	/// <returns>The cell size used, 0 if no particle collides</returns>
+	float GridBroadphase::Build() const {
+		const ParticleStorage& p = *particles;
+		uint32_t count = p.Size();
+
+		// Cells must be at least as large as the largest particle,
+		// so overlapping particles are always in neighbouring cells
+		float maxRadius = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			maxRadius = std::max(maxRadius, p.radius[i]);
+		}
+
+		float size = std::max(cellSize, 2 * maxRadius);
+		if (maxRadius <= 0) return 0;
+
+		float inverseSize = 1.0f / size;
+
+		// Twice as many buckets as particles keeps hash collisions rare
+		uint32_t bucketCount = 1;
+		while (bucketCount < 2 * count) bucketCount <<= 1;
+		bucketMask = bucketCount - 1;
+
+		cellX.resize(count);
+		cellY.resize(count);
+		bucketStart.assign(bucketCount + 1, 0);
+
+		// Count particles per bucket
+		for (uint32_t i = 0; i < count; i++) {
+			if (p.radius[i] <= 0) continue;
+
+			cellX[i] = static_cast<int32_t>(std::floor(p.positionX[i] * inverseSize));
+			cellY[i] = static_cast<int32_t>(std::floor(p.positionY[i] * inverseSize));
+			bucketStart[Bucket(cellX[i], cellY[i])]++;
+		}
+
+		// Turn the counts into bucket ends
+		uint32_t total = 0;
+		for (uint32_t b = 0; b < bucketCount; b++) {
+			total += bucketStart[b];
+			bucketStart[b] = total;
+		}
+		bucketStart[bucketCount] = total;
+
+		// Fill buckets backwards so each one ends up sorted by particle index,
+		// and the bucket ends become bucket starts
+		entries.resize(total);
+		for (uint32_t i = count; i-- > 0;) {
+			if (p.radius[i] <= 0) continue;
+
+			entries[--bucketStart[Bucket(cellX[i], cellY[i])]] = i;
+		}
+
+		return size;
+	}
+
+	unsigned GridBroadphase::AddContact(ParticleContact& contact, unsigned limit) const {
+		if (Build() == 0) return 0;
+
+		return GenerateInOrder(particles->Size(), &contact, limit, [this](uint32_t i, ParticleContact* output, unsigned limit) {
+			return CollideParticle(i, output, limit);
+		});
+	}
+
+	unsigned GridBroadphase::CollideParticle(uint32_t i, ParticleContact* output, unsigned limit) const {
+		if (particles->radius[i] <= 0) return 0;
+
+		unsigned used = 0;
+
+		// Neighbouring cells can hash to the same bucket, only visit it once
+		uint32_t visited[9];
+		unsigned visitedCount = 0;
+
+		for (int32_t dy = -1; dy <= 1; dy++) {
+			for (int32_t dx = -1; dx <= 1; dx++) {
+				uint32_t bucket = Bucket(cellX[i] + dx, cellY[i] + dy);
+
+				if (std::find(visited, visited + visitedCount, bucket) != visited + visitedCount)
+					continue;
+				visited[visitedCount++] = bucket;
+
+				// Each pair is only tested from its lowest index
+				for (uint32_t e = bucketStart[bucket]; e < bucketStart[bucket + 1]; e++) {
+					uint32_t j = entries[e];
+					if (j <= i) continue;
+
+					if (used >= limit) return used;
+					if (Collide(i, j, output[used])) used++;
+				}
+			}
+		}
+
+		return used;
+	}
+
+	// SWEEP AND PRUNE
+
+	SweepAndPruneBroadphase::SweepAndPruneBroadphase(ParticleStorage* particles)
+		: ParticleBroadphase(particles) {
+	}
+
+	void SweepAndPruneBroadphase::Sort() const {
+		const ParticleStorage& p = *particles;
+
+		// Start over if the storage was cleared
+		if (order.size() > p.Size()) order.clear();
+
+		size_t sorted = order.size();
+		size_t count = p.Size();
+
+		for (size_t k = 0; k < sorted; k++) {
+			uint32_t i = order[k];
+			minX[k] = p.positionX[i] - p.radius[i];
+		}
+
+		// Insertion sort, the order from the previous step is almost right
+		for (size_t k = 1; k < sorted; k++) {
+			uint32_t index = order[k];
+			float key = minX[k];
+
+			size_t m = k;
+			while (m > 0 && minX[m - 1] > key) {
+				order[m] = order[m - 1];
+				minX[m] = minX[m - 1];
+				m--;
+			}
+
+			order[m] = index;
+			minX[m] = key;
+		}
+
+		if (count == sorted) return;
+
+		// Particles added since the last step are in no particular order, a bulk add would make the
+		// insertion sort quadratic. Sort them on their own, ties by index, and merge them in.
+		std::vector<std::pair<float, uint32_t>> added;
+		added.reserve(count - sorted);
+		for (size_t i = sorted; i < count; i++) {
+			added.push_back({ p.positionX[i] - p.radius[i], static_cast<uint32_t>(i) });
+		}
+		std::sort(added.begin(), added.end());
+
+		order.resize(count);
+		minX.resize(count);
+
+		// From the back, so the sorted prefix is read before it is overwritten. On ties the
+		// added particles go last, as the insertion sort would have left them.
+		size_t k = sorted;
+		size_t a = added.size();
+		for (size_t out = count; a > 0; out--) {
+			if (k > 0 && minX[k - 1] > added[a - 1].first) {
+				order[out - 1] = order[k - 1];
+				minX[out - 1] = minX[k - 1];
+				k--;
+			}
+			else {
+				order[out - 1] = added[a - 1].second;
+				minX[out - 1] = added[a - 1].first;
+				a--;
+			}
+		}
+	}
+
+	unsigned SweepAndPruneBroadphase::AddContact(ParticleContact& contact, unsigned limit) const {
+		Sort();
+
+		return GenerateInOrder(static_cast<uint32_t>(order.size()), &contact, limit, [this](uint32_t k, ParticleContact* output, unsigned limit) {
+			return SweepParticle(k, output, limit);
+		});
+	}
+
+	unsigned SweepAndPruneBroadphase::SweepParticle(uint32_t k, ParticleContact* output, unsigned limit) const {
+		const ParticleStorage& p = *particles;
+
+		uint32_t i = order[k];
+		if (p.radius[i] <= 0) return 0;
+
+		unsigned used = 0;
+		float maxX = p.positionX[i] + p.radius[i];
+
+		// Only the particles starting before this one ends can overlap it
+		for (size_t m = k + 1; m < order.size() && minX[m] < maxX; m++) {
+			uint32_t j = order[m];
+			if (p.radius[j] <= 0) continue;
+
+			if (used >= limit) return used;
+
+			// Lowest index first, so contacts match the grid ones
+			if (Collide(std::min(i, j), std::max(i, j), output[used])) used++;
+		}
+
+		return used;
+	}
+
+	std::unique_ptr<ParticleBroadphase> CreateBroadphase(BroadphaseType type, ParticleStorage* particles) {
+		switch (type) {
+		case BroadphaseType::SweepAndPrune:
+			return std::make_unique<SweepAndPruneBroadphase>(particles);
+		default:
+			return std::make_unique<GridBroadphase>(particles);
+		}
+	}
+}
@@ -0,0 +1,202 @@
+#include <Brise/PConstraints.h>
+#include <Brise/BriseAssert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Brise {
+
+	namespace {
+		constexpr uint32_t NO_BODY = std::numeric_limits<uint32_t>::max();
+	}
+
+	uint32_t ParticleConstraintSolver::AddDistance(ParticleHandle a, ParticleHandle b, float length, float compliance) {
+		return Add(a, b, length, compliance, false);
+	}
+
+	uint32_t ParticleConstraintSolver::AddMaxDistance(ParticleHandle a, ParticleHandle b, float maxLength, float compliance) {
+		return Add(a, b, maxLength, compliance, true);
+	}
+
+	uint32_t ParticleConstraintSolver::Add(ParticleHandle a, ParticleHandle b, float length, float compliance, bool maxDistance) {
+		BR_ASSERT(a.GetStorage() == b.GetStorage());
+		BR_ASSERT(a.GetIndex() != b.GetIndex());
+		BR_ASSERT(compliance >= 0);
+
+		added.push_back({ a, b, length, compliance, maxDistance });
+		dirty = true;
+
+		return static_cast<uint32_t>(added.size()) - 1;
+	}
+
+	void ParticleConstraintSolver::Remove(uint32_t constraint) {
+		BR_ASSERT(constraint < added.size());
+
+		added.erase(added.begin() + constraint);
+		dirty = true;
+	}
+
+	void ParticleConstraintSolver::Clear() {
+		added.clear();
+		dirty = true;
+	}
+
+	ParticleHandle ParticleConstraintSolver::GetParticle(uint32_t constraint, unsigned end) const {
+		return end == 0 ? added[constraint].a : added[constraint].b;
+	}
+
+	void ParticleConstraintSolver::Build() {
+		dirty = false;
+
+		uint32_t count = static_cast<uint32_t>(added.size());
+		bodyA.resize(count);
+		bodyB.resize(count);
+		length.resize(count);
+		compliance.resize(count);
+		maxDistance.resize(count);
+		lambda.resize(count);
+
+		// Each constrained particle becomes one body, in order of first use
+		std::vector<uint32_t> bodyOf;
+		bodyParticle.clear();
+
+		auto bodyFor = [&](uint32_t particle) {
+			if (particle >= bodyOf.size()) bodyOf.resize(particle + 1, NO_BODY);
+			if (bodyOf[particle] == NO_BODY) {
+				bodyOf[particle] = static_cast<uint32_t>(bodyParticle.size());
+				bodyParticle.push_back(particle);
+			}
+			return bodyOf[particle];
+		};
+
+		for (uint32_t c = 0; c < count; c++) {
+			const Constraint& constraint = added[c];
+
+			bodyA[c] = bodyFor(constraint.a.GetIndex());
+			bodyB[c] = bodyFor(constraint.b.GetIndex());
+			length[c] = constraint.length;
+			compliance[c] = constraint.compliance;
+			maxDistance[c] = constraint.maxDistance ? 1 : 0;
+		}
+
+		size_t bodies = bodyParticle.size();
+		positionX.resize(bodies);
+		positionY.resize(bodies);
+		previousX.resize(bodies);
+		previousY.resize(bodies);
+		velocityX.resize(bodies);
+		velocityY.resize(bodies);
+		accelerationX.resize(bodies);
+		accelerationY.resize(bodies);
+		inverseMass.resize(bodies);
+	}
+
+	void ParticleConstraintSolver::Prepare(ParticleStorage& storage) {
+		if (dirty) Build();
+
+		prepared = not added.empty();
+		if (not prepared) return;
+
+		BR_ASSERT(added.front().a.GetStorage() == &storage);
+
+		for (size_t i = 0; i < bodyParticle.size(); i++) {
+			uint32_t p = bodyParticle[i];
+			BR_ASSERT(p < storage.Size());
+
+			positionX[i] = storage.positionX[p];
+			positionY[i] = storage.positionY[p];
+			velocityX[i] = storage.velocityX[p];
+			velocityY[i] = storage.velocityY[p];
+
+			// Forces are cleared by the integration, keep the acceleration they give
+			inverseMass[i] = storage.IsSimulated(p) ? storage.inverseMass[p] : 0.0f;
+			accelerationX[i] = storage.accelerationX[p] + storage.forceAccumX[p] * inverseMass[i];
+			accelerationY[i] = storage.accelerationY[p] + storage.forceAccumY[p] * inverseMass[i];
+		}
+	}
+
+	void ParticleConstraintSolver::Solve(ParticleStorage& storage, float duration) {
+		if (not prepared) return;
+		prepared = false;
+
+		unsigned steps = std::max(substeps, 1u);
+		float h = duration / steps;
+		size_t bodies = bodyParticle.size();
+
+		for (unsigned step = 0; step < steps; step++) {
+			for (size_t i = 0; i < bodies; i++) {
+				if (inverseMass[i] == 0) continue;
+
+				previousX[i] = positionX[i];
+				previousY[i] = positionY[i];
+				velocityX[i] += accelerationX[i] * h;
+				velocityY[i] += accelerationY[i] * h;
+				positionX[i] += velocityX[i] * h;
+				positionY[i] += velocityY[i] * h;
+			}
+
+			std::fill(lambda.begin(), lambda.end(), 0.0f);
+			for (unsigned iteration = 0; iteration < iterations; iteration++) {
+				Project(h);
+			}
+
+			// The velocity is whatever moved the particle over the substep, corrections included
+			for (size_t i = 0; i < bodies; i++) {
+				if (inverseMass[i] == 0) continue;
+
+				velocityX[i] = (positionX[i] - previousX[i]) / h;
+				velocityY[i] = (positionY[i] - previousY[i]) / h;
+			}
+		}
+
+		// Overwrites what the integrator did for these particles
+		for (size_t i = 0; i < bodies; i++) {
+			if (inverseMass[i] == 0) continue;
+
+			uint32_t p = bodyParticle[i];
+			storage.positionX[p] = positionX[i];
+			storage.positionY[p] = positionY[i];
+			storage.velocityX[p] = velocityX[i] * storage.dampingFactor[p];
+			storage.velocityY[p] = velocityY[i] * storage.dampingFactor[p];
+		}
+	}
+
+	void ParticleConstraintSolver::Project(float substepDuration) {
+		float inverseDurationSquared = 1.0f / (substepDuration * substepDuration);
+
+		for (size_t c = 0; c < bodyA.size(); c++) {
+			uint32_t a = bodyA[c];
+			uint32_t b = bodyB[c];
+
+			float dx = positionX[a] - positionX[b];
+			float dy = positionY[a] - positionY[b];
+			float currentLength = std::sqrt(dx * dx + dy * dy);
+
+			float error = currentLength - length[c];
+			if (maxDistance[c] && error <= 0) continue; // Slack cable
+
+			float alpha = compliance[c] * inverseDurationSquared;
+			float weight = inverseMass[a] + inverseMass[b] + alpha;
+			if (weight == 0 || currentLength < 0.0001f) continue;
+
+			// XPBD : dlambda = (-C - alpha lambda) / (wa + wb + alpha)
+			float deltaLambda = (-error - alpha * lambda[c]) / weight;
+			lambda[c] += deltaLambda;
+
+			float nx = dx / currentLength;
+			float ny = dy / currentLength;
+
+			positionX[a] += nx * deltaLambda * inverseMass[a];
+			positionY[a] += ny * deltaLambda * inverseMass[a];
+			positionX[b] -= nx * deltaLambda * inverseMass[b];
+			positionY[b] -= ny * deltaLambda * inverseMass[b];
+		}
+	}
+
+	void ParticleConstraintSolver::CollectLinks(std::vector<ParticleLinkPair>& links) const {
+		for (const Constraint& constraint : added) {
+			links.push_back({ constraint.a, constraint.b });
+		}
+	}
+}
@@ -7,8 +7,8 @@ namespace Brise {
 	}
 
 	float ParticleContact::CalculateSeparatingVelocity() const {
-		Vec2 relativeVelocity = particle[0]->velocity;
-		if (particle[1]) relativeVelocity -= particle[1]->velocity;
+		Vec2 relativeVelocity = particle[0].GetVelocity();
+		if (particle[1]) relativeVelocity -= particle[1].GetVelocity();
 		return Dot(relativeVelocity, contactNormal);
 	}
 
@@ -22,8 +22,8 @@ namespace Brise {
 		float newSepVelocity = -separatingVelocity * restitution;
 
 		// Checks the velocity buildup due to acceleration only
-		Vec2 accCausedVelocity = particle[0]->acceleration;
-		if (particle[1]) accCausedVelocity -= particle[1]->acceleration;
+		Vec2 accCausedVelocity = particle[0].GetAcceleration();
+		if (particle[1]) accCausedVelocity -= particle[1].GetAcceleration();
 		float accCausedSepVelocity = Dot(accCausedVelocity, contactNormal) * duration;
 
 		// If ther's closing vel due to acceleration buildup, remove it
@@ -36,8 +36,8 @@ namespace Brise {
 		float deltaVelocity = newSepVelocity - separatingVelocity;
 
 		// Apply the change in proportion of the inverseMass
-		float totalInverseMass = particle[0]->GetInverseMass();
-		if (particle[1]) totalInverseMass += particle[1]->GetInverseMass();
+		float totalInverseMass = particle[0].GetInverseMass();
+		if (particle[1]) totalInverseMass += particle[1].GetInverseMass();
 
 		// Checks if both particles have infiniteMass
 		if (totalInverseMass <= 0) return;
@@ -47,19 +47,22 @@ namespace Brise {
 		Vec2 impulsePerIMass = contactNormal * impulse;
 
 		// Apply impulse
-		particle[0]->velocity += impulsePerIMass * particle[0]->GetInverseMass();
+		particle[0].SetVelocity(particle[0].GetVelocity() + impulsePerIMass * particle[0].GetInverseMass());
 		if (particle[1]) {
-			particle[1]->velocity += impulsePerIMass * (-particle[1]->GetInverseMass());
+			particle[1].SetVelocity(particle[1].GetVelocity() + impulsePerIMass * (-particle[1].GetInverseMass()));
 		}
 	}
 
-	void ParticleContact::ResolveInterpenetration(float duration) {
+	void ParticleContact::ResolveInterpenetration(float /*duration*/) {
+		particleMovement[0] = { 0, 0 };
+		particleMovement[1] = { 0, 0 };
+
 		// Checks if no penetration
 		if (penetration <= 0) return;
 
 		// apply the change in proportion of the inverseMass
-		float totalInverseMass = particle[0]->GetInverseMass();
-		if (particle[1]) totalInverseMass += particle[1]->GetInverseMass();
+		float totalInverseMass = particle[0].GetInverseMass();
+		if (particle[1]) totalInverseMass += particle[1].GetInverseMass();
 
 		// Checks if both particles have infiniteMass
 		if (totalInverseMass <= 0) return;
@@ -69,19 +72,22 @@ namespace Brise {
 		Vec2 movePerIMass = contactNormal * ((penetration * percent) / totalInverseMass);
 
 		Vec2 particleMovement0, particleMovement1;
-		particleMovement0 = movePerIMass * particle[0]->GetInverseMass();
+		particleMovement0 = movePerIMass * particle[0].GetInverseMass();
 		if (particle[1]) {
-			particleMovement1 = movePerIMass * (-particle[1]->GetInverseMass());
+			particleMovement1 = movePerIMass * (-particle[1].GetInverseMass());
 		}
 		else {
 			particleMovement1 = { 0, 0 };
 		}
 
 		// Apply penetration resolution
-		particle[0]->position += particleMovement0;
+		particle[0].SetPosition(particle[0].GetPosition() + particleMovement0);
 		if (particle[1]) {
-			particle[1]->position += particleMovement1;
+			particle[1].SetPosition(particle[1].GetPosition() + particleMovement1);
 		}
+
+		particleMovement[0] = particleMovement0;
+		particleMovement[1] = particleMovement1;
 	}
 
 	ParticleContactResolver::ParticleContactResolver(unsigned iterations)
@@ -92,26 +98,140 @@ namespace Brise {
 		this->iterations = iterations;
 	}
 
+	float ParticleContactResolver::Key(const ParticleContact& contact) const {
+		float sepVel = contact.CalculateSeparatingVelocity();
+
+		// Contacts separating without interpenetration need nothing
+		if (sepVel < 0 || contact.penetration > 0) return sepVel;
+		return std::numeric_limits<float>::infinity();
+	}
+
+	void ParticleContactResolver::BuildAdjacency(const std::vector<ParticleContact>& contactArray, unsigned numContacts) {
+		uint32_t particleCount = 0;
+		for (unsigned i = 0; i < numContacts; i++) {
+			for (const ParticleHandle& p : contactArray[i].particle) {
+				if (p) particleCount = std::max(particleCount, p.GetIndex() + 1);
+			}
+		}
+
+		// Count contacts per particle, then turn counts into range ends
+		adjacencyStart.assign(particleCount + 1, 0);
+		for (unsigned i = 0; i < numContacts; i++) {
+			for (const ParticleHandle& p : contactArray[i].particle) {
+				if (p) adjacencyStart[p.GetIndex()]++;
+			}
+		}
+
+		unsigned total = 0;
+		for (uint32_t i = 0; i < particleCount; i++) {
+			total += adjacencyStart[i];
+			adjacencyStart[i] = total;
+		}
+		adjacencyStart[particleCount] = total;
+
+		// Fill backwards, which turns the range ends into range starts
+		adjacency.resize(total);
+		for (unsigned i = numContacts; i-- > 0;) {
+			for (const ParticleHandle& p : contactArray[i].particle) {
+				if (p) adjacency[--adjacencyStart[p.GetIndex()]] = i;
+			}
+		}
+	}
+
 	void ParticleContactResolver::ResolveContacts(std::vector<ParticleContact>& contactArray, unsigned numContacts, float duration) {
-		unsigned i;
 		iterationsUsed = 0;
+		if (numContacts == 0) return;
+
+		BuildAdjacency(contactArray, numContacts);
+
+		// Heapify every contact by separating velocity
+		keys.resize(numContacts);
+		heap.resize(numContacts);
+		heapPosition.resize(numContacts);
+		for (unsigned i = 0; i < numContacts; i++) {
+			keys[i] = Key(contactArray[i]);
+			heap[i] = i;
+			heapPosition[i] = i;
+		}
+
+		for (unsigned i = numContacts / 2; i-- > 0;) {
+			SiftDown(i);
+		}
 
 		while (iterationsUsed < iterations) {
-			// Find contact with largest closing velocity
-			float max = std::numeric_limits<float>::max();
-			unsigned maxIndex = numContacts;
-			for (i = 0; i < numContacts; i++) {
-				float sepVel = contactArray[i].CalculateSeparatingVelocity();
-
-				if (sepVel < max && (sepVel < 0 || contactArray[i].penetration > 0)) {
-					max = sepVel;
-					maxIndex = i;
+			// Contact with largest closing velocity
+			unsigned index = heap[0];
+			if (keys[index] == std::numeric_limits<float>::infinity()) break;
+
+			ParticleContact& resolved = contactArray[index];
+			resolved.Resolve(duration);
+			iterationsUsed++;
+
+			// Update the contacts sharing a particle with the resolved one
+			for (unsigned k = 0; k < 2; k++) {
+				const ParticleHandle& moved = resolved.particle[k];
+				if (not moved) continue;
+
+				Vec2 movement = resolved.particleMovement[k];
+
+				for (unsigned a = adjacencyStart[moved.GetIndex()]; a < adjacencyStart[moved.GetIndex() + 1]; a++) {
+					ParticleContact& other = contactArray[adjacency[a]];
+
+					if (other.particle[0] == moved) {
+						other.penetration -= Dot(movement, other.contactNormal);
+					}
+					else if (other.particle[1] == moved) {
+						other.penetration += Dot(movement, other.contactNormal);
+					}
 				}
 			}
 
-			if (maxIndex == numContacts) break;
-			contactArray[maxIndex].Resolve(duration);
-			iterationsUsed++;
+			// Velocities changed too, re-key the same contacts
+			for (const ParticleHandle& moved : resolved.particle) {
+				if (not moved) continue;
+
+				for (unsigned a = adjacencyStart[moved.GetIndex()]; a < adjacencyStart[moved.GetIndex() + 1]; a++) {
+					unsigned other = adjacency[a];
+					float oldKey = keys[other];
+					keys[other] = Key(contactArray[other]);
+
+					if (keys[other] < oldKey) SiftUp(heapPosition[other]);
+					else SiftDown(heapPosition[other]);
+				}
+			}
+		}
+	}
+
+	void ParticleContactResolver::Swap(unsigned a, unsigned b) {
+		std::swap(heap[a], heap[b]);
+		heapPosition[heap[a]] = a;
+		heapPosition[heap[b]] = b;
+	}
+
+	void ParticleContactResolver::SiftUp(unsigned position) {
+		while (position > 0) {
+			unsigned parent = (position - 1) / 2;
+			if (keys[heap[parent]] <= keys[heap[position]]) break;
+
+			Swap(parent, position);
+			position = parent;
+		}
+	}
+
+	void ParticleContactResolver::SiftDown(unsigned position) {
+		unsigned size = static_cast<unsigned>(heap.size());
+
+		while (true) {
+			unsigned smallest = position;
+			unsigned left = 2 * position + 1;
+			unsigned right = left + 1;
+
+			if (left < size && keys[heap[left]] < keys[heap[smallest]]) smallest = left;
+			if (right < size && keys[heap[right]] < keys[heap[smallest]]) smallest = right;
+			if (smallest == position) break;
+
+			Swap(smallest, position);
+			position = smallest;
 		}
 	}
-}
\ No newline at end of file
+}
@@ -1,16 +1,50 @@
 #include <Brise/PForceGen.h>
 #include <Brise/BriseAssert.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+
 namespace Brise {
-	void ParticleForceRegistry::Add(Particle* particle, ParticleForceGenerator* fg) {
-		for (const auto& reg : registry) {
-			if (reg.particle == particle && reg.fg == fg)
-				return; // ignore duplicate
+	namespace {
+		constexpr uint32_t MIN_PARTICLES_PER_CHUNK = 2048;
+
+		// Generator parameters packed one after the other
+		template<typename... Fields>
+		constexpr size_t StateSize(const Fields&...) {
+			return (sizeof(Fields) + ...);
+		}
+
+		template<typename... Fields>
+		void WriteState(std::byte* state, const Fields&... fields) {
+			((std::memcpy(state, &fields, sizeof(Fields)), state += sizeof(Fields)), ...);
 		}
+
+		template<typename... Fields>
+		void ReadState(const std::byte* state, Fields&... fields) {
+			((std::memcpy(&fields, state, sizeof(Fields)), state += sizeof(Fields)), ...);
+		}
+	}
+
+	void ParticleForceGenerator::UpdateForces(ParticleStorage& particles, std::span<const uint32_t> indices, float duration) {
+		for (uint32_t i : indices) {
+			UpdateForce(ParticleHandle(&particles, i), duration);
+		}
+	}
+
+	// REGISTRY
+
+	void ParticleForceRegistry::Add(ParticleHandle particle, ParticleForceGenerator* fg) {
+		// Duplicates are dropped when batching, checking here would make adding quadratic
 		registry.push_back({ particle, fg });
+		batchesDirty = true;
 	}
 
-	void ParticleForceRegistry::Remove(Particle* particle, ParticleForceGenerator* fg) {
+	void ParticleForceRegistry::Remove(ParticleHandle particle, ParticleForceGenerator* fg) {
 		registry.erase(
 			std::remove_if(
 				registry.begin(),
@@ -22,15 +56,109 @@ namespace Brise {
 				}),
 			registry.end()
 		);
+		batchesDirty = true;
 	}
 
 	void ParticleForceRegistry::Clear() {
 		registry.clear();
+		batchesDirty = true;
 	}
 
-	void ParticleForceRegistry::UpdateForces(float duration) {
-		for (auto& reg : registry) {
-			reg.fg->UpdateForce(reg.particle, duration);
+	void ParticleForceRegistry::RemoveParticlesFrom(uint32_t count) {
+		size_t before = registry.size();
+		registry.erase(
+			std::remove_if(
+				registry.begin(),
+				registry.end(),
+				[count](const ParticleForceRegistration& reg) { return reg.particle.GetIndex() >= count; }),
+			registry.end()
+		);
+		if (registry.size() != before) batchesDirty = true;
+	}
+
+	void ParticleForceRegistry::CollectLinks(std::vector<ParticleLinkPair>& links) const {
+		for (const ParticleForceRegistration& reg : registry) {
+			ParticleHandle other = reg.fg->GetLinkedParticle();
+			if (other) links.push_back({ reg.particle, other });
+		}
+	}
+
+	/// <summary>
+	/// Sorts the registrations by generator type, then generator, then particle.
+	/// Generators of a type keep their registration order so the forces of a
+	/// particle are always summed in the same order.
+	/// </summary>
+	void ParticleForceRegistry::BuildBatches() {
+		batchesDirty = false;
+
+		std::unordered_map<const ParticleForceGenerator*, uint32_t> firstRegistration;
+		for (uint32_t r = 0; r < registry.size(); r++) {
+			firstRegistration.try_emplace(registry[r].fg, r);
+		}
+
+		auto key = [&](const ParticleForceRegistration& reg) {
+			return std::make_tuple(std::type_index(typeid(*reg.fg)), firstRegistration[reg.fg],
+				reg.particle.GetStorage(), reg.particle.GetIndex());
+		};
+
+		std::vector<ParticleForceRegistration> sorted = registry;
+		std::sort(sorted.begin(), sorted.end(),
+			[&](const ParticleForceRegistration& a, const ParticleForceRegistration& b) { return key(a) < key(b); });
+
+		batches.clear();
+		indices.clear();
+		generators.clear();
+
+		for (uint32_t r = 0; r < sorted.size(); r++) {
+			const ParticleForceRegistration& reg = sorted[r];
+
+			bool sameBatch = not batches.empty()
+				&& batches.back().fg == reg.fg
+				&& batches.back().storage == reg.particle.GetStorage();
+
+			if (sameBatch && indices.back() == reg.particle.GetIndex())
+				continue; // ignore duplicate
+
+			if (not sameBatch) {
+				// Batches of a generator over several storages are next to each other
+				if (batches.empty() || batches.back().fg != reg.fg) generators.push_back(reg.fg);
+				batches.push_back({ reg.fg, reg.particle.GetStorage(), static_cast<uint32_t>(indices.size()), 0 });
+			}
+
+			indices.push_back(reg.particle.GetIndex());
+			batches.back().count++;
+		}
+	}
+
+	std::span<ParticleForceGenerator* const> ParticleForceRegistry::GetGenerators() {
+		if (batchesDirty) BuildBatches();
+		return generators;
+	}
+
+	void ParticleForceRegistry::UpdateForces(float duration, ThreadPool* pool) {
+		if (batchesDirty) BuildBatches();
+
+		for (const ParticleForceBatch& batch : batches) {
+			std::span<const uint32_t> batchIndices(indices.data() + batch.first, batch.count);
+			const std::vector<float>& awake = batch.storage->awake;
+
+			// Leave the sleeping particles out, only copying if there are any
+			auto asleep = std::find_if(batchIndices.begin(), batchIndices.end(), [&](uint32_t i) { return awake[i] == 0; });
+			if (asleep != batchIndices.end()) {
+				awakeIndices.assign(batchIndices.begin(), asleep);
+				std::copy_if(asleep, batchIndices.end(), std::back_inserter(awakeIndices), [&](uint32_t i) { return awake[i] != 0; });
+				batchIndices = awakeIndices;
+			}
+
+			if (pool && batch.fg->IsThreadSafe()) {
+				// Particles of a batch are unique, each range only writes its own
+				pool->ParallelFor(static_cast<uint32_t>(batchIndices.size()), MIN_PARTICLES_PER_CHUNK, [&](uint32_t begin, uint32_t end, unsigned) {
+					batch.fg->UpdateForces(*batch.storage, batchIndices.subspan(begin, end - begin), duration);
+				});
+			}
+			else {
+				batch.fg->UpdateForces(*batch.storage, batchIndices, duration);
+			}
 		}
 	}
 
@@ -39,19 +167,30 @@ namespace Brise {
 	ParticleGravity::ParticleGravity(const Vec2& gravityForce) 
 	: gravity(gravityForce) {}
 
-	void ParticleGravity::UpdateForce(Particle* particle, float duration) {
-		if (not particle->HasFiniteMass()) return;
+	void ParticleGravity::UpdateForce(ParticleHandle particle, float /*duration*/) {
+		if (not particle.HasFiniteMass()) return;
 
-		particle->AddForce(gravity * particle->GetMass());
+		particle.AddForce(gravity * particle.GetMass());
+	}
+
+	void ParticleGravity::UpdateForces(ParticleStorage& p, std::span<const uint32_t> indices, float /*duration*/) {
+		for (uint32_t i : indices) {
+			float invMass = p.inverseMass[i];
+			if (invMass == 0) continue;
+
+			float mass = 1.0f / invMass;
+			p.forceAccumX[i] += gravity.x * mass;
+			p.forceAccumY[i] += gravity.y * mass;
+		}
 	}
 
 	// SPRINGS
 
-	ParticleSpring::ParticleSpring(Particle* other, float springConstant, float restLength)
+	ParticleSpring::ParticleSpring(ParticleHandle other, float springConstant, float restLength)
 		: other(other), springConstant(springConstant), restLength(restLength) {}
 
-	void ParticleSpring::UpdateForce(Particle* particle, float duration) {
-		Vec2 force = particle->position - other->position;
+	void ParticleSpring::UpdateForce(ParticleHandle particle, float /*duration*/) {
+		Vec2 force = particle.GetPosition() - other.GetPosition();
 
 		float length = Magnitude(force);
 		if (length <= 0.0001f) return;
@@ -64,7 +203,24 @@ namespace Brise {
 		// Hooke : F = -k (x - L0)
 		force *= -magnitude;
 
-		particle->AddForce(force);
+		particle.AddForce(force);
+	}
+
+	void ParticleSpring::UpdateForces(ParticleStorage& p, std::span<const uint32_t> indices, float /*duration*/) {
+		Vec2 otherPosition = other.GetPosition();
+
+		for (uint32_t i : indices) {
+			float dx = p.positionX[i] - otherPosition.x;
+			float dy = p.positionY[i] - otherPosition.y;
+
+			float length = std::sqrt(dx * dx + dy * dy);
+			if (length <= 0.0001f) continue;
+
+			float magnitude = (length - restLength) * springConstant;
+
+			p.forceAccumX[i] += dx / length * -magnitude;
+			p.forceAccumY[i] += dy / length * -magnitude;
+		}
 	}
 
 	// ANCHORED SPRING
@@ -72,8 +228,8 @@ namespace Brise {
 	AnchoredParticleSpring::AnchoredParticleSpring(Vec2 anchor, float springConstant, float restLength)
 		: anchor(anchor), springConstant(springConstant), restLength(restLength) {}
 
-	void AnchoredParticleSpring::UpdateForce(Particle* particle, float duration) {
-		Vec2 delta = particle->position - anchor;
+	void AnchoredParticleSpring::UpdateForce(ParticleHandle particle, float /*duration*/) {
+		Vec2 delta = particle.GetPosition() - anchor;
 
 		float length = Magnitude(delta);
 		if (length <= 0.0001f) return;
@@ -83,16 +239,31 @@ namespace Brise {
 		Vec2 force = delta / length;
 		force *= -springConstant * displacement;
 
-		particle->AddForce(force);
+		particle.AddForce(force);
+	}
+
+	void AnchoredParticleSpring::UpdateForces(ParticleStorage& p, std::span<const uint32_t> indices, float /*duration*/) {
+		for (uint32_t i : indices) {
+			float dx = p.positionX[i] - anchor.x;
+			float dy = p.positionY[i] - anchor.y;
+
+			float length = std::sqrt(dx * dx + dy * dy);
+			if (length <= 0.0001f) continue;
+
+			float scale = -springConstant * (length - restLength);
+
+			p.forceAccumX[i] += dx / length * scale;
+			p.forceAccumY[i] += dy / length * scale;
+		}
 	}
 
 	// BUNGEE SPRING
 
-	ParticleBungee::ParticleBungee(Particle* other, float springConstant, float restLength)
+	ParticleBungee::ParticleBungee(ParticleHandle other, float springConstant, float restLength)
 		: other(other), springConstant(springConstant), restLength(restLength) { }
 
-	void ParticleBungee::UpdateForce(Particle* particle, float duration) {
-		Vec2 delta = particle->position - other->position;
+	void ParticleBungee::UpdateForce(ParticleHandle particle, float /*duration*/) {
+		Vec2 delta = particle.GetPosition() - other.GetPosition();
 
 		float length = Magnitude(delta);
 		if (length <= 0.0001f) return;
@@ -105,7 +276,26 @@ namespace Brise {
 		Vec2 force = delta / length;
 		force *= -springConstant * displacement;
 
-		particle->AddForce(force);
+		particle.AddForce(force);
+	}
+
+	void ParticleBungee::UpdateForces(ParticleStorage& p, std::span<const uint32_t> indices, float /*duration*/) {
+		Vec2 otherPosition = other.GetPosition();
+
+		for (uint32_t i : indices) {
+			float dx = p.positionX[i] - otherPosition.x;
+			float dy = p.positionY[i] - otherPosition.y;
+
+			float length = std::sqrt(dx * dx + dy * dy);
+
+			// Bungees only pull
+			if (length <= 0.0001f || length <= restLength) continue;
+
+			float scale = -springConstant * (length - restLength);
+
+			p.forceAccumX[i] += dx / length * scale;
+			p.forceAccumY[i] += dy / length * scale;
+		}
 	}
 
 	// BUYOANCY
@@ -113,9 +303,9 @@ namespace Brise {
 		: maxDepth(maxDepth), volume(volume), waterHeight(waterHeight), liquidDensity(liquidDensity) 
 	{ }
 
-	void ParticleBuoyancy::UpdateForce(Particle* particle, float duration) {
+	void ParticleBuoyancy::UpdateForce(ParticleHandle particle, float /*duration*/) {
 		// Get submersion depth
-		float depth = particle->position.y;
+		float depth = particle.GetPosition().y;
 
 		// Checks if out of water
 		if (depth >= waterHeight + maxDepth) return;
@@ -124,13 +314,90 @@ namespace Brise {
 		// Checks if you're at max depth
 		if (depth <= waterHeight - maxDepth) {
 			force.y = liquidDensity * volume;
-			particle->AddForce(force);
+			particle.AddForce(force);
 			return;
 		}
 
 		// Otherwise, partyly submerged
 		float submerged = (waterHeight + maxDepth - depth) / (2.0f * maxDepth);
 		force.y = liquidDensity * volume * submerged;
-		particle->AddForce(force);
+		particle.AddForce(force);
+	}
+
+	void ParticleBuoyancy::UpdateForces(ParticleStorage& p, std::span<const uint32_t> indices, float /*duration*/) {
+		float fullForce = liquidDensity * volume;
+		float top = waterHeight + maxDepth;
+		float bottom = waterHeight - maxDepth;
+
+		for (uint32_t i : indices) {
+			float depth = p.positionY[i];
+			if (depth >= top) continue;
+
+			// Fully or partly submerged
+			float submerged = depth <= bottom ? 1.0f : (top - depth) / (2.0f * maxDepth);
+			p.forceAccumY[i] += fullForce * submerged;
+		}
+	}
+
+	// STATE
+
+	size_t ParticleGravity::GetStateSize() const {
+		return StateSize(gravity);
+	}
+
+	void ParticleGravity::SaveState(std::byte* state) const {
+		WriteState(state, gravity);
+	}
+
+	void ParticleGravity::RestoreState(const std::byte* state) {
+		ReadState(state, gravity);
+	}
+
+	size_t ParticleSpring::GetStateSize() const {
+		return StateSize(springConstant, restLength);
+	}
+
+	void ParticleSpring::SaveState(std::byte* state) const {
+		WriteState(state, springConstant, restLength);
+	}
+
+	void ParticleSpring::RestoreState(const std::byte* state) {
+		ReadState(state, springConstant, restLength);
+	}
+
+	size_t AnchoredParticleSpring::GetStateSize() const {
+		return StateSize(anchor, springConstant, restLength);
+	}
+
+	void AnchoredParticleSpring::SaveState(std::byte* state) const {
+		WriteState(state, anchor, springConstant, restLength);
+	}
+
+	void AnchoredParticleSpring::RestoreState(const std::byte* state) {
+		ReadState(state, anchor, springConstant, restLength);
+	}
+
+	size_t ParticleBungee::GetStateSize() const {
+		return StateSize(springConstant, restLength);
+	}
+
+	void ParticleBungee::SaveState(std::byte* state) const {
+		WriteState(state, springConstant, restLength);
+	}
+
+	void ParticleBungee::RestoreState(const std::byte* state) {
+		ReadState(state, springConstant, restLength);
+	}
+
+	size_t ParticleBuoyancy::GetStateSize() const {
+		return StateSize(maxDepth, volume, waterHeight, liquidDensity);
+	}
+
+	void ParticleBuoyancy::SaveState(std::byte* state) const {
+		WriteState(state, maxDepth, volume, waterHeight, liquidDensity);
+	}
+
+	void ParticleBuoyancy::RestoreState(const std::byte* state) {
+		ReadState(state, maxDepth, volume, waterHeight, liquidDensity);
 	}
-}
\ No newline at end of file
+}
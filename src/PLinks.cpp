@@ -1,12 +1,33 @@
 #include <Brise/PLinks.h>
+#include <Brise/BriseAssert.h>
+
+#include <cmath>
 
 namespace Brise {
+    namespace {
+        // Rods within this distance of their length produce no contact
+        constexpr float ROD_TOLERANCE = 0.0001f;
+
+        constexpr uint32_t MIN_LINKS_PER_CHUNK = 1024;
+    }
+
     float ParticleLink::CurrentLength() const {
-        Vec2 relativePos = particle[0]->position - particle[1]->position;
+        Vec2 relativePos = particle[0].GetPosition() - particle[1].GetPosition();
         return Magnitude(relativePos);
     }
 
+    bool ParticleLink::IsSimulated() const {
+        return particle[0].GetStorage()->IsSimulated(particle[0].GetIndex())
+            || particle[1].GetStorage()->IsSimulated(particle[1].GetIndex());
+    }
+
+    void ParticleLink::CollectLinks(std::vector<ParticleLinkPair>& links) const {
+        links.push_back({ particle[0], particle[1] });
+    }
+
     unsigned ParticleCable::AddContact(ParticleContact& contact, unsigned limit) const {
+        if (limit == 0 || not IsSimulated()) return 0;
+
         float length = CurrentLength();
 
         // Checks if we're overextended
@@ -17,7 +38,7 @@ namespace Brise {
         contact.particle[1] = particle[1];
 
         // Calculate the normal
-        Vec2 normal = Normalize(particle[1]->position - particle[0]->position);
+        Vec2 normal = Normalize(particle[1].GetPosition() - particle[0].GetPosition());
         contact.contactNormal = normal;
         contact.penetration = length - maxLength;
         contact.restitution = restitution;
@@ -26,17 +47,19 @@ namespace Brise {
     }
 
     unsigned ParticleRod::AddContact(ParticleContact& contact, unsigned limit) const {
+        if (limit == 0 || not IsSimulated()) return 0;
+
         float currentLength = CurrentLength();
 
-        // Checks if overextended
-        if (currentLength == length) return 0;
+        // Checks if overextended or compressed
+        if (std::abs(currentLength - length) <= ROD_TOLERANCE) return 0;
 
         // Otherwise, return the contact
         contact.particle[0] = particle[0];
         contact.particle[1] = particle[1];
 
         // Calculate the normal
-        Vec2 normal = Normalize(particle[1]->position - particle[0]->position);
+        Vec2 normal = Normalize(particle[1].GetPosition() - particle[0].GetPosition());
 
         // Contact normal depends on wheter we're extending or compressing
         if (currentLength > length) {
@@ -52,4 +75,135 @@ namespace Brise {
 
         return 1;
     }
-}
\ No newline at end of file
+
+    // LINK SETS
+
+    ParticleLinkSet::ParticleLinkSet(ParticleStorage* particles)
+        : particles(particles) {
+    }
+
+    void ParticleLinkSet::Add(ParticleHandle a, ParticleHandle b, float linkLength, float linkRestitution) {
+        BR_ASSERT(a.GetStorage() == particles && b.GetStorage() == particles);
+
+        particleA.push_back(a.GetIndex());
+        particleB.push_back(b.GetIndex());
+        length.push_back(linkLength);
+        restitution.push_back(linkRestitution);
+    }
+
+    void ParticleLinkSet::Remove(uint32_t link) {
+        BR_ASSERT(link < GetLinkCount());
+
+        particleA.erase(particleA.begin() + link);
+        particleB.erase(particleB.begin() + link);
+        length.erase(length.begin() + link);
+        restitution.erase(restitution.begin() + link);
+    }
+
+    void ParticleLinkSet::Clear() {
+        particleA.clear();
+        particleB.clear();
+        length.clear();
+        restitution.clear();
+    }
+
+    ParticleHandle ParticleLinkSet::GetParticle(uint32_t link, unsigned end) const {
+        return ParticleHandle(particles, end == 0 ? particleA[link] : particleB[link]);
+    }
+
+    unsigned ParticleLinkSet::AddContact(ParticleContact& contact, unsigned limit) const {
+        return AddContacts({ &contact, limit });
+    }
+
+    unsigned ParticleLinkSet::AddContacts(std::span<ParticleContact> contacts) const {
+        uint32_t count = GetLinkCount();
+        if (count == 0 || contacts.empty()) return 0;
+
+        normalX.resize(count);
+        normalY.resize(count);
+        penetration.resize(count);
+        active.resize(count);
+
+        if (threadPool) {
+            threadPool->ParallelFor(count, MIN_LINKS_PER_CHUNK, [this](uint32_t begin, uint32_t end, unsigned) { Measure(begin, end); });
+        }
+        else {
+            Measure(0, count);
+        }
+
+        // Writes the active links in order, like one generator per link would
+        unsigned used = 0;
+        for (uint32_t i = 0; i < count && used < contacts.size(); i++) {
+            if (not active[i]) continue;
+
+            ParticleContact& contact = contacts[used++];
+            contact.particle[0] = ParticleHandle(particles, particleA[i]);
+            contact.particle[1] = ParticleHandle(particles, particleB[i]);
+            contact.contactNormal = { normalX[i], normalY[i] };
+            contact.penetration = penetration[i];
+            contact.restitution = restitution[i];
+        }
+
+        return used;
+    }
+
+    void ParticleLinkSet::CollectLinks(std::vector<ParticleLinkPair>& links) const {
+        for (uint32_t i = 0; i < GetLinkCount(); i++) {
+            links.push_back({ ParticleHandle(particles, particleA[i]), ParticleHandle(particles, particleB[i]) });
+        }
+    }
+
+    void ParticleCableSet::AddCable(ParticleHandle a, ParticleHandle b, float maxLength, float restitution) {
+        Add(a, b, maxLength, restitution);
+    }
+
+    void ParticleCableSet::Measure(uint32_t begin, uint32_t end) const {
+        const ParticleStorage& p = *particles;
+
+        for (uint32_t i = begin; i < end; i++) {
+            uint32_t a = particleA[i];
+            uint32_t b = particleB[i];
+
+            float dx = p.positionX[b] - p.positionX[a];
+            float dy = p.positionY[b] - p.positionY[a];
+            float currentLength = std::sqrt(dx * dx + dy * dy);
+            float inverseLength = currentLength > 0 ? 1.0f / currentLength : 0.0f;
+
+            // Nothing to do between sleeping or infinite mass particles
+            float moving = p.awake[a] * p.inverseMass[a] + p.awake[b] * p.inverseMass[b];
+
+            normalX[i] = dx * inverseLength;
+            normalY[i] = dy * inverseLength;
+            penetration[i] = currentLength - length[i];
+            active[i] = (currentLength >= length[i]) & (moving > 0);
+        }
+    }
+
+    void ParticleRodSet::AddRod(ParticleHandle a, ParticleHandle b, float length) {
+        Add(a, b, length, 0);
+    }
+
+    void ParticleRodSet::Measure(uint32_t begin, uint32_t end) const {
+        const ParticleStorage& p = *particles;
+
+        for (uint32_t i = begin; i < end; i++) {
+            uint32_t a = particleA[i];
+            uint32_t b = particleB[i];
+
+            float dx = p.positionX[b] - p.positionX[a];
+            float dy = p.positionY[b] - p.positionY[a];
+            float currentLength = std::sqrt(dx * dx + dy * dy);
+            float inverseLength = currentLength > 0 ? 1.0f / currentLength : 0.0f;
+
+            float moving = p.awake[a] * p.inverseMass[a] + p.awake[b] * p.inverseMass[b];
+
+            // Pulls the particles together when extended, pushes them apart when compressed
+            float direction = currentLength > length[i] ? inverseLength : -inverseLength;
+
+            normalX[i] = dx * direction;
+            normalY[i] = dy * direction;
+            penetration[i] = std::abs(currentLength - length[i]);
+            active[i] = (std::abs(currentLength - length[i]) > ROD_TOLERANCE) & (moving > 0);
+        }
+    }
+}
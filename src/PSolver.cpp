@@ -0,0 +1,319 @@
+#include <Brise/PSolver.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace Brise {
+
+	namespace {
+		// Impulses smaller than this are considered converged
+		constexpr float CONVERGED_IMPULSE = 1e-6f;
+
+		// Cached normals must be this close to the new one to warm start
+		constexpr float SAME_NORMAL_COSINE = 0.95f;
+
+		// Contacts left once the colours run out share the last one, solved on a single thread
+		constexpr uint32_t MAX_COLORS = 64;
+		constexpr uint32_t SERIAL_COLOR = MAX_COLORS - 1;
+
+		// Fewer contacts per thread than this aren't worth waking the workers
+		constexpr uint32_t MIN_CONTACTS_PER_THREAD = 32;
+
+		// Key of the contact's particle pair, independent of the particles order.
+		// The normal is flipped to match when the order is swapped.
+		uint64_t PairKey(const ParticleContact& contact, Vec2& normal) {
+			uint32_t a = contact.particle[0].GetIndex();
+			uint32_t b = contact.particle[1] ? contact.particle[1].GetIndex() : INVALID_PARTICLE;
+			normal = contact.contactNormal;
+
+			if (b < a) {
+				std::swap(a, b);
+				normal = -normal;
+			}
+
+			return (static_cast<uint64_t>(a) << 32) | b;
+		}
+	}
+
+	SequentialImpulseSolver::SequentialImpulseSolver(unsigned iterations)
+		: iterations(iterations) {
+	}
+
+	void SequentialImpulseSolver::SetIterations(unsigned iterations) {
+		this->iterations = iterations;
+	}
+
+	void SequentialImpulseSolver::ClearCache() {
+		cache.clear();
+	}
+
+	void SequentialImpulseSolver::SetCache(std::span<const CachedImpulse> impulses) {
+		cache.assign(impulses.begin(), impulses.end());
+	}
+
+	void SequentialImpulseSolver::SetThreadPool(ThreadPool* pool) {
+		threadPool = pool;
+	}
+
+	/// <summary>
+	/// Greedy colouring of the contacts, each one takes the lowest colour not used
+	/// yet by its particles. Particles with infinite mass are never written to and
+	/// don't constrain the colours.
+	/// </summary>
+	void SequentialImpulseSolver::ColorContacts(const std::vector<ParticleContact>& contactArray, unsigned numContacts) {
+		auto dynamicIndex = [](const ParticleHandle& particle) {
+			return particle && particle.HasFiniteMass() ? particle.GetIndex() : INVALID_PARTICLE;
+		};
+
+		uint32_t particleCount = 0;
+		for (unsigned i = 0; i < numContacts; i++) {
+			particleCount = std::max(particleCount, contactArray[i].particle[0].GetIndex() + 1);
+			if (contactArray[i].particle[1]) {
+				particleCount = std::max(particleCount, contactArray[i].particle[1].GetIndex() + 1);
+			}
+		}
+
+		particleColors.assign(particleCount, 0);
+		contactColor.resize(numContacts);
+		colorStart.assign(MAX_COLORS + 1, 0);
+
+		for (unsigned i = 0; i < numContacts; i++) {
+			uint32_t a = dynamicIndex(contactArray[i].particle[0]);
+			uint32_t b = dynamicIndex(contactArray[i].particle[1]);
+
+			uint64_t used = 0;
+			if (a != INVALID_PARTICLE) used |= particleColors[a];
+			if (b != INVALID_PARTICLE) used |= particleColors[b];
+
+			uint32_t color = std::min(static_cast<uint32_t>(std::countr_one(used)), SERIAL_COLOR);
+			if (color != SERIAL_COLOR) {
+				if (a != INVALID_PARTICLE) particleColors[a] |= uint64_t(1) << color;
+				if (b != INVALID_PARTICLE) particleColors[b] |= uint64_t(1) << color;
+			}
+
+			contactColor[i] = color;
+			colorStart[color + 1]++;
+		}
+
+		// Counting sort, contacts keep their relative order inside a colour
+		for (uint32_t c = 0; c < MAX_COLORS; c++) {
+			colorStart[c + 1] += colorStart[c];
+		}
+
+		colorOrder.resize(numContacts);
+		for (unsigned i = 0; i < numContacts; i++) {
+			colorOrder[colorStart[contactColor[i]]++] = i;
+		}
+
+		for (uint32_t c = MAX_COLORS; c > 0; c--) {
+			colorStart[c] = colorStart[c - 1];
+		}
+		colorStart[0] = 0;
+	}
+
+	/// <summary>
+	/// Calls function(contactIndex, worker) on every contact, colour by colour.
+	/// Without a thread pool the colours are walked in the same order, so the
+	/// solve order, and the results, don't depend on the thread count.
+	/// </summary>
+	template<typename Function>
+	void SequentialImpulseSolver::ForEachContact(Function&& function) {
+		for (uint32_t color = 0; color < MAX_COLORS; color++) {
+			uint32_t first = colorStart[color];
+			uint32_t count = colorStart[color + 1] - first;
+
+			if (not threadPool || color == SERIAL_COLOR) {
+				for (uint32_t i = first; i < first + count; i++) {
+					function(colorOrder[i], 0u);
+				}
+				continue;
+			}
+
+			threadPool->ParallelFor(count, MIN_CONTACTS_PER_THREAD, [&](uint32_t begin, uint32_t end, unsigned worker) {
+				for (uint32_t i = first + begin; i < first + end; i++) {
+					function(colorOrder[i], worker);
+				}
+			});
+		}
+	}
+
+	void SequentialImpulseSolver::Solve(std::vector<ParticleContact>& contactArray, unsigned numContacts, float duration,
+		const ParticleIslands* islands) {
+		iterationsUsed = 0;
+
+		effectiveMass.resize(numContacts);
+		targetVelocity.resize(numContacts);
+		accumulatedImpulse.resize(numContacts);
+
+		if (UseIslands(islands, numContacts)) SolveIslands(contactArray, *islands, duration);
+		else SolveColors(contactArray, numContacts, duration);
+
+		// Remember the impulses for the next step
+		nextCache.clear();
+		for (unsigned i = 0; i < numContacts; i++) {
+			if (accumulatedImpulse[i] <= 0) continue;
+
+			Vec2 normal;
+			uint64_t key = PairKey(contactArray[i], normal);
+			nextCache.push_back({ key, normal, accumulatedImpulse[i] });
+		}
+
+		std::stable_sort(nextCache.begin(), nextCache.end(),
+			[](const CachedImpulse& a, const CachedImpulse& b) { return a.key < b.key; });
+		std::swap(cache, nextCache);
+	}
+
+	/// <summary>
+	/// Islands are worth it if they can keep every thread busy,
+	/// which needs the largest one to hold at most a thread's share of the contacts.
+	/// </summary>
+	bool SequentialImpulseSolver::UseIslands(const ParticleIslands* islands, unsigned numContacts) const {
+		if (not threadPool || not islands || islands->GetIslandCount() < threadPool->GetThreadCount()) return false;
+
+		size_t largest = 0;
+		for (uint32_t island = 0; island < islands->GetIslandCount(); island++) {
+			largest = std::max(largest, islands->GetContacts(island).size());
+		}
+
+		return largest * threadPool->GetThreadCount() <= numContacts;
+	}
+
+	void SequentialImpulseSolver::SolveIslands(std::vector<ParticleContact>& contactArray, const ParticleIslands& islands, float duration) {
+		workerIterations.assign(threadPool->GetThreadCount(), 0);
+
+		// Contacts without simulated particles belong to no island
+		std::fill(accumulatedImpulse.begin(), accumulatedImpulse.end(), 0.0f);
+
+		// Each island is solved in order on a single thread, like the serial solver would
+		threadPool->ParallelFor(islands.GetIslandCount(), 1, [&](uint32_t begin, uint32_t end, unsigned worker) {
+			for (uint32_t island = begin; island < end; island++) {
+				std::span<const uint32_t> islandContacts = islands.GetContacts(island);
+
+				for (uint32_t i : islandContacts) {
+					PrepareContact(contactArray, i, duration);
+				}
+
+				unsigned used = 0;
+				while (used < iterations) {
+					float largestImpulse = 0;
+					for (uint32_t i : islandContacts) {
+						largestImpulse = std::max(largestImpulse, SolveContact(contactArray[i], i));
+					}
+					used++;
+
+					if (largestImpulse < CONVERGED_IMPULSE) break;
+				}
+
+				workerIterations[worker] = std::max(workerIterations[worker], used);
+			}
+		});
+
+		iterationsUsed = *std::max_element(workerIterations.begin(), workerIterations.end());
+	}
+
+	void SequentialImpulseSolver::SolveColors(std::vector<ParticleContact>& contactArray, unsigned numContacts, float duration) {
+		workerImpulse.resize(threadPool ? threadPool->GetThreadCount() : 1);
+
+		ColorContacts(contactArray, numContacts);
+
+		// Warm starting moves particles too, so it runs in batches as well
+		ForEachContact([&](uint32_t i, unsigned) {
+			PrepareContact(contactArray, i, duration);
+		});
+
+		while (iterationsUsed < iterations) {
+			std::fill(workerImpulse.begin(), workerImpulse.end(), 0.0f);
+
+			ForEachContact([&](uint32_t i, unsigned worker) {
+				workerImpulse[worker] = std::max(workerImpulse[worker], SolveContact(contactArray[i], i));
+			});
+			iterationsUsed++;
+
+			float largestImpulse = *std::max_element(workerImpulse.begin(), workerImpulse.end());
+			if (largestImpulse < CONVERGED_IMPULSE) break;
+		}
+	}
+
+	void SequentialImpulseSolver::PrepareContact(std::vector<ParticleContact>& contactArray, unsigned index, float duration) {
+		ParticleContact& contact = contactArray[index];
+
+		float totalInverseMass = contact.particle[0].GetInverseMass();
+		if (contact.particle[1]) totalInverseMass += contact.particle[1].GetInverseMass();
+
+		accumulatedImpulse[index] = 0;
+
+		// Checks if both particles have infiniteMass
+		if (totalInverseMass <= 0) {
+			effectiveMass[index] = 0;
+			return;
+		}
+
+		effectiveMass[index] = 1.0f / totalInverseMass;
+
+		// Bounce on fast impacts, and push out of interpenetration otherwise
+		float separatingVelocity = contact.CalculateSeparatingVelocity();
+		float bounce = separatingVelocity < -restitutionThreshold ? -contact.restitution * separatingVelocity : 0;
+		float push = baumgarte / duration * std::max(contact.penetration - penetrationSlop, 0.0f);
+		targetVelocity[index] = std::max(bounce, push);
+
+		if (not warmStarting) return;
+
+		Vec2 normal;
+		uint64_t key = PairKey(contact, normal);
+
+		if (const CachedImpulse* cached = FindCached(key, normal)) {
+			accumulatedImpulse[index] = cached->impulse;
+			ApplyImpulse(contact, cached->impulse);
+		}
+	}
+
+	float SequentialImpulseSolver::SolveContact(ParticleContact& contact, unsigned index) {
+		if (effectiveMass[index] == 0) return 0;
+
+		float separatingVelocity = contact.CalculateSeparatingVelocity();
+		float impulse = effectiveMass[index] * (targetVelocity[index] - separatingVelocity);
+
+		// Clamp the total impulse, contacts can push but never pull
+		float accumulated = std::max(accumulatedImpulse[index] + impulse, 0.0f);
+		impulse = accumulated - accumulatedImpulse[index];
+		accumulatedImpulse[index] = accumulated;
+
+		ApplyImpulse(contact, impulse);
+		return std::fabs(impulse);
+	}
+
+	void SequentialImpulseSolver::ApplyImpulse(ParticleContact& contact, float impulse) {
+		Vec2 impulseVector = contact.contactNormal * impulse;
+
+		// Particles with infinite mass are left untouched, they can be shared by contacts solved in parallel
+		ParticleHandle& a = contact.particle[0];
+		if (a.HasFiniteMass()) {
+			a.SetVelocity(a.GetVelocity() + impulseVector * a.GetInverseMass());
+		}
+
+		if (contact.particle[1] && contact.particle[1].HasFiniteMass()) {
+			ParticleHandle& b = contact.particle[1];
+			b.SetVelocity(b.GetVelocity() - impulseVector * b.GetInverseMass());
+		}
+	}
+
+	const SequentialImpulseSolver::CachedImpulse* SequentialImpulseSolver::FindCached(uint64_t key, Vec2 normal) const {
+		auto range = std::equal_range(cache.begin(), cache.end(), CachedImpulse{ key, {}, 0 },
+			[](const CachedImpulse& a, const CachedImpulse& b) { return a.key < b.key; });
+
+		// A particle can touch several static colliders, match the closest normal
+		const CachedImpulse* best = nullptr;
+		float bestCosine = SAME_NORMAL_COSINE;
+
+		for (auto it = range.first; it != range.second; ++it) {
+			float cosine = Dot(it->normal, normal);
+			if (cosine > bestCosine) {
+				bestCosine = cosine;
+				best = &*it;
+			}
+		}
+
+		return best;
+	}
+}
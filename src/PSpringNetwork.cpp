@@ -0,0 +1,405 @@
+#include <Brise/PSpringNetwork.h>
+#include <Brise/BriseAssert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Brise {
+
+	namespace {
+		constexpr uint32_t MIN_SPRINGS_PER_CHUNK = 4096;
+		constexpr uint32_t MIN_PARTICLES_PER_CHUNK = 2048;
+	}
+
+	ParticleSpringNetwork::ParticleSpringNetwork(ParticleStorage* particles)
+		: particles(particles) {
+	}
+
+	void ParticleSpringNetwork::AddSpring(ParticleHandle a, ParticleHandle b, float springConstant, float restLength) {
+		Add(a, b, springConstant, restLength, false);
+	}
+
+	void ParticleSpringNetwork::AddBungee(ParticleHandle a, ParticleHandle b, float springConstant, float restLength) {
+		Add(a, b, springConstant, restLength, true);
+	}
+
+	void ParticleSpringNetwork::Add(ParticleHandle a, ParticleHandle b, float springConstant, float restLength, bool bungee) {
+		BR_ASSERT(a.GetStorage() == particles && b.GetStorage() == particles);
+		BR_ASSERT(a.GetIndex() != b.GetIndex());
+
+		added.push_back({ a.GetIndex(), b.GetIndex(), springConstant, restLength, bungee });
+		dirty = true;
+	}
+
+	void ParticleSpringNetwork::Clear() {
+		added.clear();
+		dirty = true;
+	}
+
+	void ParticleSpringNetwork::Build() {
+		dirty = false;
+
+		std::vector<Spring> sorted = added;
+		for (Spring& spring : sorted) {
+			if (spring.b < spring.a) std::swap(spring.a, spring.b);
+		}
+
+		// Springs sharing a first particle end up next to each other
+		std::stable_sort(sorted.begin(), sorted.end(), [](const Spring& x, const Spring& y) {
+			return x.a != y.a ? x.a < y.a : x.b < y.b;
+		});
+
+		uint32_t count = static_cast<uint32_t>(sorted.size());
+
+		uint32_t rows = 0;
+		for (const Spring& spring : sorted) {
+			rows = std::max(rows, spring.b + 1);
+		}
+
+		rowStart.assign(rows + 1, 0);
+		columnStart.assign(rows + 1, 0);
+		columnSprings.resize(count);
+		springA.resize(count);
+		springB.resize(count);
+		springConstant.resize(count);
+		restLength.resize(count);
+		minDisplacement.resize(count);
+		forceX.resize(count);
+		forceY.resize(count);
+
+		for (uint32_t s = 0; s < count; s++) {
+			const Spring& spring = sorted[s];
+
+			springA[s] = spring.a;
+			springB[s] = spring.b;
+			springConstant[s] = spring.springConstant;
+			restLength[s] = spring.restLength;
+			minDisplacement[s] = spring.bungee ? 0.0f : -std::numeric_limits<float>::infinity();
+
+			rowStart[spring.a + 1]++;
+			columnStart[spring.b + 1]++;
+		}
+
+		for (uint32_t row = 0; row < rows; row++) {
+			rowStart[row + 1] += rowStart[row];
+			columnStart[row + 1] += columnStart[row];
+		}
+
+		// Springs by second particle, each column sorted by spring index
+		std::vector<uint32_t> next(columnStart.begin(), columnStart.end() - 1);
+		for (uint32_t s = 0; s < count; s++) {
+			columnSprings[next[springB[s]]++] = s;
+		}
+	}
+
+	void ParticleSpringNetwork::UpdateForces(float duration, ThreadPool* pool) {
+		if (dirty) Build();
+
+		if (implicit) {
+			SolveImplicit(duration, pool);
+			return;
+		}
+
+		uint32_t springs = static_cast<uint32_t>(springA.size());
+		uint32_t rows = static_cast<uint32_t>(rowStart.size()) - 1;
+
+		if (pool) {
+			pool->ParallelFor(springs, MIN_SPRINGS_PER_CHUNK, [this](uint32_t begin, uint32_t end, unsigned) { ComputeForces(begin, end); });
+			pool->ParallelFor(rows, MIN_PARTICLES_PER_CHUNK, [this](uint32_t begin, uint32_t end, unsigned) { GatherForces(begin, end); });
+		}
+		else {
+			ComputeForces(0, springs);
+			GatherForces(0, rows);
+		}
+	}
+
+	void ParticleSpringNetwork::ComputeForces(uint32_t begin, uint32_t end) {
+		const ParticleStorage& p = *particles;
+
+		// No branches so the loop vectorises across springs
+		for (uint32_t s = begin; s < end; s++) {
+			uint32_t a = springA[s];
+			uint32_t b = springB[s];
+
+			float dx = p.positionX[a] - p.positionX[b];
+			float dy = p.positionY[a] - p.positionY[b];
+			float length = std::sqrt(dx * dx + dy * dy);
+
+			// Hooke : F = -k (x - L0), bungees don't push
+			float displacement = std::max(length - restLength[s], minDisplacement[s]);
+
+			// Springs between two sleeping particles do nothing
+			float active = std::max(p.awake[a], p.awake[b]);
+
+			float scale = length > 0.0001f ? -springConstant[s] * displacement / length * active : 0.0f;
+			forceX[s] = dx * scale;
+			forceY[s] = dy * scale;
+		}
+	}
+
+	void ParticleSpringNetwork::GatherForces(uint32_t begin, uint32_t end) {
+		ParticleStorage& p = *particles;
+
+		for (uint32_t i = begin; i < end; i++) {
+			float sumX, sumY;
+			SumSprings(i, forceX, forceY, sumX, sumY);
+
+			p.forceAccumX[i] += sumX;
+			p.forceAccumY[i] += sumY;
+		}
+	}
+
+	void ParticleSpringNetwork::SumSprings(uint32_t i, const std::vector<float>& valueX, const std::vector<float>& valueY, float& sumX, float& sumY) const {
+		sumX = 0;
+		sumY = 0;
+
+		// Each particle sums the springs starting at it, then subtracts those ending at it
+		for (uint32_t s = rowStart[i]; s < rowStart[i + 1]; s++) {
+			sumX += valueX[s];
+			sumY += valueY[s];
+		}
+
+		for (uint32_t c = columnStart[i]; c < columnStart[i + 1]; c++) {
+			sumX -= valueX[columnSprings[c]];
+			sumY -= valueY[columnSprings[c]];
+		}
+	}
+
+	// IMPLICIT INTEGRATION
+
+	void ParticleSpringNetwork::SolveImplicit(float duration, ThreadPool* pool) {
+		ParticleStorage& p = *particles;
+
+		uint32_t springs = static_cast<uint32_t>(springA.size());
+		uint32_t rows = static_cast<uint32_t>(rowStart.size()) - 1;
+
+		auto run = [pool](uint32_t count, uint32_t minChunk, auto&& function) {
+			if (pool) pool->ParallelFor(count, minChunk, [&function](uint32_t begin, uint32_t end, unsigned) { function(begin, end); });
+			else function(0, count);
+		};
+
+		mass.resize(rows);
+		diagonalX.resize(rows);
+		diagonalY.resize(rows);
+		deltaVX.resize(rows);
+		deltaVY.resize(rows);
+		residualX.resize(rows);
+		residualY.resize(rows);
+		directionX.resize(rows);
+		directionY.resize(rows);
+		productX.resize(rows);
+		productY.resize(rows);
+		stiffnessXX.resize(springs);
+		stiffnessXY.resize(springs);
+		stiffnessYY.resize(springs);
+
+		run(springs, MIN_SPRINGS_PER_CHUNK, [this, duration](uint32_t begin, uint32_t end) {
+			ComputeForces(begin, end);
+			ComputeStiffness(begin, end, duration);
+		});
+
+		// Total force, the spring forces gathered before ApplySystem reuses forceX/Y
+		run(rows, MIN_PARTICLES_PER_CHUNK, [this, &p](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				mass[i] = p.IsSimulated(i) ? 1.0f / p.inverseMass[i] : 0.0f;
+
+				float springX, springY;
+				SumSprings(i, forceX, forceY, springX, springY);
+				residualX[i] = p.forceAccumX[i] + springX + p.accelerationX[i] * mass[i];
+				residualY[i] = p.forceAccumY[i] + springY + p.accelerationY[i] * mass[i];
+			}
+		});
+
+		// Right hand side dt f + dt^2 K v, in the residual until the solve starts
+		ApplySystem(p.velocityX, p.velocityY, pool);
+		run(rows, MIN_PARTICLES_PER_CHUNK, [&](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				// productX/Y holds M v + dt^2 (-K) v, keep the spring part only
+				float forceTotalX = residualX[i];
+				float forceTotalY = residualY[i];
+				float stiffVX = productX[i] - mass[i] * p.velocityX[i];
+				float stiffVY = productY[i] - mass[i] * p.velocityY[i];
+
+				float rhsX = mass[i] > 0 ? duration * forceTotalX - stiffVX : 0.0f;
+				float rhsY = mass[i] > 0 ? duration * forceTotalY - stiffVY : 0.0f;
+
+				// Diagonal of M + dt^2 (-K), each spring adds its own block to both ends
+				float diagX = mass[i];
+				float diagY = mass[i];
+				for (uint32_t s = rowStart[i]; s < rowStart[i + 1]; s++) {
+					diagX += stiffnessXX[s];
+					diagY += stiffnessYY[s];
+				}
+				for (uint32_t c = columnStart[i]; c < columnStart[i + 1]; c++) {
+					diagX += stiffnessXX[columnSprings[c]];
+					diagY += stiffnessYY[columnSprings[c]];
+				}
+				diagonalX[i] = mass[i] > 0 ? diagX : 1.0f;
+				diagonalY[i] = mass[i] > 0 ? diagY : 1.0f;
+
+				// Start from the explicit velocity change, preconditioned
+				deltaVX[i] = rhsX / diagonalX[i];
+				deltaVY[i] = rhsY / diagonalY[i];
+				residualX[i] = rhsX;
+				residualY[i] = rhsY;
+			}
+		});
+
+		float rhsNorm = Sum(pool, [this](uint32_t i) { return residualX[i] * residualX[i] + residualY[i] * residualY[i]; });
+
+		// r = b - A x0, p = r / diagonal
+		ApplySystem(deltaVX, deltaVY, pool);
+		run(rows, MIN_PARTICLES_PER_CHUNK, [this](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				residualX[i] -= productX[i];
+				residualY[i] -= productY[i];
+				directionX[i] = residualX[i] / diagonalX[i];
+				directionY[i] = residualY[i] / diagonalY[i];
+			}
+		});
+
+		float threshold = tolerance * tolerance * rhsNorm;
+		float rz = Sum(pool, [this](uint32_t i) { return residualX[i] * directionX[i] + residualY[i] * directionY[i]; });
+
+		iterationsUsed = 0;
+		while (iterationsUsed < maxIterations && rz > 0) {
+			float residualNorm = Sum(pool, [this](uint32_t i) { return residualX[i] * residualX[i] + residualY[i] * residualY[i]; });
+			if (residualNorm <= threshold) break;
+
+			iterationsUsed++;
+
+			ApplySystem(directionX, directionY, pool);
+			float curvature = Sum(pool, [this](uint32_t i) { return directionX[i] * productX[i] + directionY[i] * productY[i]; });
+			if (curvature <= 0) break;
+
+			float alpha = rz / curvature;
+			run(rows, MIN_PARTICLES_PER_CHUNK, [this, alpha](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; i++) {
+					deltaVX[i] += alpha * directionX[i];
+					deltaVY[i] += alpha * directionY[i];
+					residualX[i] -= alpha * productX[i];
+					residualY[i] -= alpha * productY[i];
+				}
+			});
+
+			float nextRz = Sum(pool, [this](uint32_t i) { return residualX[i] * residualX[i] / diagonalX[i] + residualY[i] * residualY[i] / diagonalY[i]; });
+			float beta = nextRz / rz;
+			rz = nextRz;
+
+			run(rows, MIN_PARTICLES_PER_CHUNK, [this, beta](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; i++) {
+					directionX[i] = residualX[i] / diagonalX[i] + beta * directionX[i];
+					directionY[i] = residualY[i] / diagonalY[i] + beta * directionY[i];
+				}
+			});
+		}
+
+		// The force the integrator turns into this velocity change
+		float inverseDuration = 1.0f / duration;
+		run(rows, MIN_PARTICLES_PER_CHUNK, [&](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				if (mass[i] == 0) continue;
+
+				p.forceAccumX[i] = mass[i] * (deltaVX[i] * inverseDuration - p.accelerationX[i]);
+				p.forceAccumY[i] = mass[i] * (deltaVY[i] * inverseDuration - p.accelerationY[i]);
+			}
+		});
+	}
+
+	void ParticleSpringNetwork::ComputeStiffness(uint32_t begin, uint32_t end, float duration) {
+		const ParticleStorage& p = *particles;
+		float durationSquared = duration * duration;
+
+		for (uint32_t s = begin; s < end; s++) {
+			uint32_t a = springA[s];
+			uint32_t b = springB[s];
+
+			float dx = p.positionX[a] - p.positionX[b];
+			float dy = p.positionY[a] - p.positionY[b];
+			float length = std::sqrt(dx * dx + dy * dy);
+			float inverseLength = length > 0.0001f ? 1.0f / length : 0.0f;
+			float nx = dx * inverseLength;
+			float ny = dy * inverseLength;
+
+			// Slack bungees and springs between sleeping particles are not stiff
+			float stretched = length - restLength[s] >= minDisplacement[s] ? 1.0f : 0.0f;
+			float active = std::max(p.awake[a], p.awake[b]) * stretched * (length > 0.0001f ? 1.0f : 0.0f);
+
+			// -dF/dx = k (n n^T + (1 - L / l) (I - n n^T)), the transverse part clamped
+			// to stay positive so the system remains symmetric positive definite
+			float transverse = std::max(0.0f, 1.0f - restLength[s] * inverseLength);
+			float k = springConstant[s] * durationSquared * active;
+
+			stiffnessXX[s] = k * (nx * nx + transverse * (1 - nx * nx));
+			stiffnessXY[s] = k * (nx * ny - transverse * nx * ny);
+			stiffnessYY[s] = k * (ny * ny + transverse * (1 - ny * ny));
+		}
+	}
+
+	void ParticleSpringNetwork::ApplySystem(const std::vector<float>& inX, const std::vector<float>& inY, ThreadPool* pool) {
+		uint32_t springs = static_cast<uint32_t>(springA.size());
+		uint32_t rows = static_cast<uint32_t>(rowStart.size()) - 1;
+
+		// Each spring pushes its ends apart by its stiffness times their difference, kept in forceX/Y
+		auto perSpring = [this, &inX, &inY](uint32_t begin, uint32_t end, unsigned) {
+			for (uint32_t s = begin; s < end; s++) {
+				uint32_t a = springA[s];
+				uint32_t b = springB[s];
+
+				float dx = (mass[a] > 0 ? inX[a] : 0.0f) - (mass[b] > 0 ? inX[b] : 0.0f);
+				float dy = (mass[a] > 0 ? inY[a] : 0.0f) - (mass[b] > 0 ? inY[b] : 0.0f);
+
+				forceX[s] = stiffnessXX[s] * dx + stiffnessXY[s] * dy;
+				forceY[s] = stiffnessXY[s] * dx + stiffnessYY[s] * dy;
+			}
+		};
+
+		auto perParticle = [this, &inX, &inY](uint32_t begin, uint32_t end, unsigned) {
+			for (uint32_t i = begin; i < end; i++) {
+				float sumX, sumY;
+				SumSprings(i, forceX, forceY, sumX, sumY);
+
+				productX[i] = mass[i] > 0 ? mass[i] * inX[i] + sumX : 0.0f;
+				productY[i] = mass[i] > 0 ? mass[i] * inY[i] + sumY : 0.0f;
+			}
+		};
+
+		if (pool) {
+			pool->ParallelFor(springs, MIN_SPRINGS_PER_CHUNK, perSpring);
+			pool->ParallelFor(rows, MIN_PARTICLES_PER_CHUNK, perParticle);
+		}
+		else {
+			perSpring(0, springs, 0);
+			perParticle(0, rows, 0);
+		}
+	}
+
+	template<typename Term>
+	float ParticleSpringNetwork::Sum(ThreadPool* pool, Term&& term) {
+		uint32_t rows = static_cast<uint32_t>(rowStart.size()) - 1;
+
+		if (not pool) {
+			double sum = 0;
+			for (uint32_t i = 0; i < rows; i++) sum += term(i);
+			return static_cast<float>(sum);
+		}
+
+		partialSums.assign(pool->GetChunkCount(rows, MIN_PARTICLES_PER_CHUNK), 0.0f);
+		pool->ParallelForChunks(rows, MIN_PARTICLES_PER_CHUNK, [this, &term](uint32_t chunk, uint32_t begin, uint32_t end, unsigned) {
+			double sum = 0;
+			for (uint32_t i = begin; i < end; i++) sum += term(i);
+			partialSums[chunk] = static_cast<float>(sum);
+		});
+
+		double sum = 0;
+		for (float partial : partialSums) sum += partial;
+		return static_cast<float>(sum);
+	}
+
+	void ParticleSpringNetwork::CollectLinks(std::vector<ParticleLinkPair>& links) const {
+		for (const Spring& spring : added) {
+			links.push_back({ ParticleHandle(particles, spring.a), ParticleHandle(particles, spring.b) });
+		}
+	}
+}
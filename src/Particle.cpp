@@ -1,78 +1,148 @@
 #include <Brise/Particle.h>
 #include <Brise/BriseAssert.h>
+#include <Brise/Integrator.h>
+#include <algorithm>
 #include <limits>
 
 namespace Brise {
-	Particle::Particle(Vec2 position, float mass, float damping) 
-	: position(position), damping(damping) {
-		SetMass(mass);
-		velocity = { 0, 0 };
-		acceleration = { 0, 0 };
 
-		forceAccum = { 0, 0 };
+	// STORAGE
+
+	uint32_t ParticleStorage::Add(Vec2 position, float mass, float damping) {
+		BR_ASSERT(mass > 0);
+
+		positionX.push_back(position.x);
+		positionY.push_back(position.y);
+		velocityX.push_back(0);
+		velocityY.push_back(0);
+		accelerationX.push_back(0);
+		accelerationY.push_back(0);
+		forceAccumX.push_back(0);
+		forceAccumY.push_back(0);
+		inverseMass.push_back(1 / mass);
+		this->damping.push_back(damping);
+		radius.push_back(0);
+		awake.push_back(1);
+		restingSteps.push_back(0);
+		dampingFactor.push_back(1);
+		previousAccelerationX.push_back(0);
+		previousAccelerationY.push_back(0);
+		previousPositionX.push_back(position.x);
+		previousPositionY.push_back(position.y);
+
+		return Size() - 1;
 	}
 
-	/// <summary>
-	/// Integrates the particle forward in time by the given amount.
-	/// Using Newton Euler integration.
-	/// </summary>
-	/// <param name="duration">In ms</param>
-	void Particle::Integrate(float duration) {
-		// Don't integrate particles with infinite mass
-		if (inverseMass == 0) return;
+	void ParticleStorage::Reserve(size_t capacity) {
+		positionX.reserve(capacity);
+		positionY.reserve(capacity);
+		velocityX.reserve(capacity);
+		velocityY.reserve(capacity);
+		accelerationX.reserve(capacity);
+		accelerationY.reserve(capacity);
+		forceAccumX.reserve(capacity);
+		forceAccumY.reserve(capacity);
+		inverseMass.reserve(capacity);
+		damping.reserve(capacity);
+		radius.reserve(capacity);
+		awake.reserve(capacity);
+		restingSteps.reserve(capacity);
+		dampingFactor.reserve(capacity);
+		previousAccelerationX.reserve(capacity);
+		previousAccelerationY.reserve(capacity);
+		previousPositionX.reserve(capacity);
+		previousPositionY.reserve(capacity);
+	}
 
-		BR_ASSERT(duration > 0);
+	void ParticleStorage::Clear() {
+		positionX.clear();
+		positionY.clear();
+		velocityX.clear();
+		velocityY.clear();
+		accelerationX.clear();
+		accelerationY.clear();
+		forceAccumX.clear();
+		forceAccumY.clear();
+		inverseMass.clear();
+		damping.clear();
+		radius.clear();
+		awake.clear();
+		restingSteps.clear();
+		dampingFactor.clear();
+		dampingFactorCount = 0;
+		previousAccelerationX.clear();
+		previousAccelerationY.clear();
+		previousAccelerationCount = 0;
+		previousPositionX.clear();
+		previousPositionY.clear();
+	}
 
-		// Update Linear Position
-		position += velocity * duration;
+	void ParticleStorage::SavePreviousPositions() {
+		std::copy(positionX.begin(), positionX.end(), previousPositionX.begin());
+		std::copy(positionY.begin(), positionY.end(), previousPositionY.begin());
+	}
 
-		// Get acceleration from the forces
-		Vec2 resultingAcc = acceleration;
-		resultingAcc += forceAccum * inverseMass;
+	// HANDLE
 
-		// Update velocity from acceleration
-		velocity += resultingAcc * duration;
+	void ParticleHandle::SetPosition(const Vec2& value) {
+		storage->positionX[index] = value.x;
+		storage->positionY[index] = value.y;
+		storage->previousPositionX[index] = value.x;
+		storage->previousPositionY[index] = value.y;
+	}
 
-		// Impose Drag
-		velocity *= pow(damping, duration);
+	void ParticleHandle::Integrate(float dt) {
+		IntegrateParticle(*storage, index, dt, IntegratorType::Euler);
+	}
 
-		// Clear the accumulator
-		ClearAccumulator();
+	void ParticleHandle::Integrate(float dt, IntegratorType type) {
+		IntegrateParticle(*storage, index, dt, type);
 	}
 
-	void Particle::SetMass(float value) {
+	void ParticleHandle::SetMass(float value) {
 		BR_ASSERT(value > 0);
 
-		inverseMass = 1 / value;
+		storage->inverseMass[index] = 1 / value;
 	}
 
-	void Particle::SetInfiniteMass() {
-		inverseMass = 0;
+	void ParticleHandle::SetInfiniteMass() {
+		storage->inverseMass[index] = 0;
 	}
 
-	float Particle::GetMass() const {
+	float ParticleHandle::GetMass() const {
+		float inverseMass = storage->inverseMass[index];
 		if (inverseMass == 0) return std::numeric_limits<float>::max();
-		
+
 		return (1.0f / inverseMass);
 	}
 
-	float Particle::GetInverseMass() const {
-		return inverseMass;
+	void ParticleHandle::AddForce(const Vec2& force) {
+		storage->forceAccumX[index] += force.x;
+		storage->forceAccumY[index] += force.y;
 	}
 
-	void Particle::AddForce(const Vec2& force) {
-		forceAccum += force;
+	void ParticleHandle::ClearAccumulator() {
+		storage->forceAccumX[index] = 0;
+		storage->forceAccumY[index] = 0;
 	}
 
-	void Particle::ClearAccumulator() {
-		forceAccum = { 0, 0 };
+	bool ParticleHandle::HasFiniteMass() const {
+		return (storage->inverseMass[index] > 0 ? true : false);
 	}
 
-	bool Particle::HasFiniteMass() {
-		return (inverseMass > 0 ? true : false);
+	void ParticleHandle::SetAwake(bool value) {
+		storage->awake[index] = value ? 1.0f : 0.0f;
+		storage->restingSteps[index] = 0;
+
+		// Sleeping particles don't keep their residual motion
+		if (not value) SetVelocity({ 0, 0 });
 	}
 
-	void Particle::SetDamping(float value) {
-		damping = value;
+	void ParticleHandle::SetDamping(float value) {
+		storage->damping[index] = value;
+
+		// Invalidate the cached damping factor
+		if (index < storage->dampingFactorCount)
+			storage->dampingFactorCount = index;
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,117 @@
+#include <Brise/Profiler.h>
+#include <Brise/BriseAssert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Brise {
+
+	// ROLLING STATISTIC
+
+	RollingStat::RollingStat(uint32_t window) {
+		SetWindow(window);
+	}
+
+	void RollingStat::Add(double value) {
+		if (count == samples.size()) sum -= samples[next];
+		else count++;
+
+		samples[next] = value;
+		sum += value;
+		next = (next + 1) % static_cast<uint32_t>(samples.size());
+
+		// Removing old samples from the sum accumulates rounding errors, start over once per window
+		if (next == 0) sum = std::accumulate(samples.begin(), samples.begin() + count, 0.0);
+	}
+
+	void RollingStat::Clear() {
+		next = 0;
+		count = 0;
+		sum = 0;
+	}
+
+	void RollingStat::SetWindow(uint32_t window) {
+		BR_ASSERT(window > 0);
+
+		samples.assign(window, 0);
+		Clear();
+	}
+
+	double RollingStat::GetLast() const {
+		if (count == 0) return 0;
+		return samples[(next + samples.size() - 1) % samples.size()];
+	}
+
+	double RollingStat::GetAverage() const {
+		return count == 0 ? 0 : sum / count;
+	}
+
+	double RollingStat::GetMax() const {
+		if (count == 0) return 0;
+		return *std::max_element(samples.begin(), samples.begin() + count);
+	}
+
+	double RollingStat::GetPercentile(double p) const {
+		if (count == 0) return 0;
+
+		// Samples are in ring order, but only their values matter here
+		sorted.assign(samples.begin(), samples.begin() + count);
+		size_t rank = static_cast<size_t>(std::ceil(std::clamp(p, 0.0, 1.0) * count));
+		size_t index = rank == 0 ? 0 : rank - 1;
+
+		std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+		return sorted[index];
+	}
+
+#if BRISE_ENABLE_PROFILER
+
+	// WORLD PROFILER
+
+	void WorldProfiler::SetWindow(uint32_t window) {
+		for (RollingStat& stat : stats) {
+			stat.SetWindow(window);
+		}
+	}
+
+	void WorldProfiler::Clear() {
+		for (RollingStat& stat : stats) {
+			stat.Clear();
+		}
+	}
+
+	void WorldProfiler::RecordContacts(std::span<const ParticleContact> contacts) {
+		stepContacts = static_cast<unsigned>(contacts.size());
+		stepPenetration = 0;
+
+		for (const ParticleContact& contact : contacts) {
+			stepPenetration = std::max(stepPenetration, contact.penetration);
+		}
+	}
+
+	void WorldProfiler::RecordStep(const StepTimings& timings, unsigned resolverIterations) {
+		auto add = [this](ProfileStat stat, double value) { stats[static_cast<size_t>(stat)].Add(value); };
+
+		add(ProfileStat::Forces, timings.forces);
+		add(ProfileStat::Integration, timings.integration);
+		add(ProfileStat::ContactGeneration, timings.contacts);
+		add(ProfileStat::Islands, timings.islands);
+		add(ProfileStat::Resolution, timings.resolution);
+		add(ProfileStat::Sleeping, timings.sleeping);
+		add(ProfileStat::Step, timings.forces + timings.integration + timings.contacts
+			+ timings.islands + timings.resolution + timings.sleeping);
+
+		add(ProfileStat::Contacts, stepContacts);
+		add(ProfileStat::ResolverIterations, resolverIterations);
+		add(ProfileStat::MaxPenetration, stepPenetration);
+
+		stepContacts = 0;
+		stepPenetration = 0;
+	}
+
+	void WorldProfiler::RecordUpdate(unsigned steps) {
+		stats[static_cast<size_t>(ProfileStat::StepsPerUpdate)].Add(steps);
+	}
+
+#endif
+}
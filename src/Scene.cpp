@@ -0,0 +1,694 @@
+#include <Brise/Scene.h>
+#include <Brise/BriseAssert.h>
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+
+#if defined(_WIN32)
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Brise {
+	namespace {
+		constexpr uint32_t SCENE_MAGIC = 0x43535242; // "BRSC"
+		constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+		enum Section : uint32_t {
+			// One float per particle
+			POSITION_X,
+			POSITION_Y,
+			VELOCITY_X,
+			VELOCITY_Y,
+			ACCELERATION_X,
+			ACCELERATION_Y,
+			INVERSE_MASS,
+			DAMPING,
+			RADIUS,
+			AWAKE,
+
+			NETWORKS,
+			SPRINGS,
+			CABLES,
+			RODS,
+			CONSTRAINTS,
+			GEOMETRIES,
+			PLANES,
+			SEGMENTS,
+			POLYGONS,
+			VERTICES,
+			BROADPHASES,
+			GENERATORS,
+			REGISTRATIONS,
+			SECTION_COUNT
+		};
+
+		struct SceneSection {
+			uint64_t offset; // From the start of the file
+			uint64_t count;  // Elements
+		};
+
+		struct SceneHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t particleCount;
+			uint32_t sectionCount;
+			SceneSection sections[SECTION_COUNT];
+		};
+
+		// Springs [firstSpring, firstSpring + springCount)
+		struct SceneNetwork {
+			uint32_t firstSpring;
+			uint32_t springCount;
+			uint32_t implicit;
+			uint32_t maxIterations;
+			float tolerance;
+		};
+
+		struct SceneSpring {
+			uint32_t a;
+			uint32_t b;
+			float springConstant;
+			float restLength;
+			uint32_t bungee;
+		};
+
+		// Cables and rods, rods have no restitution
+		struct SceneLink {
+			uint32_t a;
+			uint32_t b;
+			float length;
+			float restitution;
+		};
+
+		struct SceneConstraint {
+			uint32_t a;
+			uint32_t b;
+			float length;
+			float compliance;
+			uint32_t maxDistance;
+		};
+
+		// A static contact generator and its geometry, ranges into the plane, segment and polygon sections
+		struct SceneGeometry {
+			float restitution;
+			uint32_t firstPlane;
+			uint32_t planeCount;
+			uint32_t firstSegment;
+			uint32_t segmentCount;
+			uint32_t firstPolygon;
+			uint32_t polygonCount;
+		};
+
+		struct ScenePlane {
+			Vec2 normal;
+			float offset;
+		};
+
+		struct SceneSegment {
+			Vec2 a;
+			Vec2 b;
+		};
+
+		// Vertices [firstVertex, firstVertex + vertexCount) of the vertex section
+		struct ScenePolygon {
+			uint32_t firstVertex;
+			uint32_t vertexCount;
+		};
+
+		struct SceneBroadphase {
+			uint32_t type; // BroadphaseType
+			float restitution;
+			float cellSize;
+		};
+
+		enum class GeneratorType : uint32_t {
+			Gravity,        // values: gravity x, y
+			Spring,         // other, values: spring constant, rest length
+			AnchoredSpring, // values: anchor x, y, spring constant, rest length
+			Bungee,         // other, values: spring constant, rest length
+			Buoyancy        // values: max depth, volume, water height, liquid density
+		};
+
+		struct SceneGenerator {
+			GeneratorType type;
+			uint32_t other; // Particle at the other end of springs and bungees
+			float values[4];
+		};
+
+		struct SceneRegistration {
+			uint32_t particle;
+			uint32_t generator;
+		};
+
+		constexpr size_t SECTION_ELEMENT_SIZE[SECTION_COUNT] = {
+			sizeof(float), sizeof(float), sizeof(float), sizeof(float), sizeof(float),
+			sizeof(float), sizeof(float), sizeof(float), sizeof(float), sizeof(float),
+			sizeof(SceneNetwork),
+			sizeof(SceneSpring),
+			sizeof(SceneLink),
+			sizeof(SceneLink),
+			sizeof(SceneConstraint),
+			sizeof(SceneGeometry),
+			sizeof(ScenePlane),
+			sizeof(SceneSegment),
+			sizeof(ScenePolygon),
+			sizeof(Vec2),
+			sizeof(SceneBroadphase),
+			sizeof(SceneGenerator),
+			sizeof(SceneRegistration)
+		};
+
+		// Sections are read in place, so every element type must be plain data
+		static_assert(sizeof(Vec2) == 2 * sizeof(float));
+		static_assert(sizeof(SceneHeader) % SECTION_ALIGNMENT == 0);
+
+		const SceneHeader& Header(std::span<const std::byte> file) {
+			return *reinterpret_cast<const SceneHeader*>(file.data());
+		}
+
+		template<typename T>
+		std::span<const T> Get(std::span<const std::byte> file, Section section) {
+			const SceneSection& range = Header(file).sections[section];
+			return { reinterpret_cast<const T*>(file.data() + range.offset), static_cast<size_t>(range.count) };
+		}
+
+		bool IsValid(std::span<const std::byte> file) {
+			if (file.size() < sizeof(SceneHeader)) return false;
+
+			const SceneHeader& header = Header(file);
+			if (header.magic != SCENE_MAGIC || header.version != SCENE_VERSION || header.sectionCount != SECTION_COUNT) {
+				return false;
+			}
+
+			for (uint32_t s = 0; s < SECTION_COUNT; s++) {
+				const SceneSection& range = header.sections[s];
+				if (range.offset % SECTION_ALIGNMENT != 0 || range.offset > file.size()) return false;
+				if (range.count > (file.size() - range.offset) / SECTION_ELEMENT_SIZE[s]) return false;
+				if (s <= AWAKE && range.count != header.particleCount) return false;
+			}
+
+			return true;
+		}
+
+		// Every index into the particles or another section is in range, so loading can't fail
+		// halfway. Scans the records, unlike IsValid which only looks at the header.
+		bool HasValidReferences(std::span<const std::byte> file) {
+			uint32_t particleCount = Header(file).particleCount;
+			auto pair = [particleCount](uint32_t a, uint32_t b) { return a < particleCount && b < particleCount && a != b; };
+			auto range = [](uint32_t first, uint32_t count, size_t size) { return first + uint64_t(count) <= size; };
+
+			std::span<const SceneSpring> springs = Get<SceneSpring>(file, SPRINGS);
+			for (const SceneNetwork& network : Get<SceneNetwork>(file, NETWORKS)) {
+				if (not range(network.firstSpring, network.springCount, springs.size())) return false;
+			}
+			for (const SceneSpring& spring : springs) {
+				if (not pair(spring.a, spring.b)) return false;
+			}
+
+			for (Section section : { CABLES, RODS }) {
+				for (const SceneLink& link : Get<SceneLink>(file, section)) {
+					if (not pair(link.a, link.b)) return false;
+				}
+			}
+
+			for (const SceneConstraint& constraint : Get<SceneConstraint>(file, CONSTRAINTS)) {
+				if (not pair(constraint.a, constraint.b) || not (constraint.compliance >= 0)) return false;
+			}
+
+			size_t vertexCount = Get<Vec2>(file, VERTICES).size();
+			std::span<const ScenePolygon> polygons = Get<ScenePolygon>(file, POLYGONS);
+			for (const SceneGeometry& geometry : Get<SceneGeometry>(file, GEOMETRIES)) {
+				if (not range(geometry.firstPlane, geometry.planeCount, Get<ScenePlane>(file, PLANES).size())) return false;
+				if (not range(geometry.firstSegment, geometry.segmentCount, Get<SceneSegment>(file, SEGMENTS).size())) return false;
+				if (not range(geometry.firstPolygon, geometry.polygonCount, polygons.size())) return false;
+			}
+			for (const ScenePolygon& polygon : polygons) {
+				if (polygon.vertexCount == 0 || not range(polygon.firstVertex, polygon.vertexCount, vertexCount)) return false;
+			}
+
+			for (const SceneBroadphase& broadphase : Get<SceneBroadphase>(file, BROADPHASES)) {
+				BroadphaseType type = static_cast<BroadphaseType>(broadphase.type);
+				if (type != BroadphaseType::Grid && type != BroadphaseType::SweepAndPrune) return false;
+			}
+
+			std::span<const SceneGenerator> generators = Get<SceneGenerator>(file, GENERATORS);
+			for (const SceneGenerator& generator : generators) {
+				switch (generator.type) {
+				case GeneratorType::Spring:
+				case GeneratorType::Bungee:
+					if (generator.other >= particleCount) return false;
+					break;
+				case GeneratorType::Gravity:
+				case GeneratorType::AnchoredSpring:
+				case GeneratorType::Buoyancy:
+					break;
+				default:
+					return false;
+				}
+			}
+
+			for (const SceneRegistration& registration : Get<SceneRegistration>(file, REGISTRATIONS)) {
+				if (registration.particle >= particleCount || registration.generator >= generators.size()) return false;
+			}
+
+			return true;
+		}
+
+		// Parameters of the built-in generators, false for custom ones
+		bool DescribeGenerator(const ParticleForceGenerator* fg, const ParticleStorage& particles, SceneGenerator& record) {
+			record = { GeneratorType::Gravity, INVALID_PARTICLE, {} };
+
+			auto describeSpring = [&](GeneratorType type, ParticleHandle other, float springConstant, float restLength) {
+				record = { type, other.GetIndex(), { springConstant, restLength } };
+				return other.GetStorage() == &particles;
+			};
+
+			if (auto gravity = dynamic_cast<const ParticleGravity*>(fg)) {
+				record.values[0] = gravity->GetGravity().x;
+				record.values[1] = gravity->GetGravity().y;
+				return true;
+			}
+			if (auto spring = dynamic_cast<const ParticleSpring*>(fg)) {
+				return describeSpring(GeneratorType::Spring, spring->GetOther(), spring->GetSpringConstant(), spring->GetRestLength());
+			}
+			if (auto bungee = dynamic_cast<const ParticleBungee*>(fg)) {
+				return describeSpring(GeneratorType::Bungee, bungee->GetOther(), bungee->GetSpringConstant(), bungee->GetRestLength());
+			}
+			if (auto anchored = dynamic_cast<const AnchoredParticleSpring*>(fg)) {
+				record = { GeneratorType::AnchoredSpring, INVALID_PARTICLE,
+					{ anchored->GetAnchor().x, anchored->GetAnchor().y, anchored->GetSpringConstant(), anchored->GetRestLength() } };
+				return true;
+			}
+			if (auto buoyancy = dynamic_cast<const ParticleBuoyancy*>(fg)) {
+				record = { GeneratorType::Buoyancy, INVALID_PARTICLE,
+					{ buoyancy->GetMaxDepth(), buoyancy->GetVolume(), buoyancy->GetWaterHeight(), buoyancy->GetLiquidDensity() } };
+				return true;
+			}
+			return false;
+		}
+	}
+
+	// EXPORT
+
+	bool ExportScene(const World& world, const char* path) {
+		const ParticleStorage& particles = world.GetParticles();
+		auto inWorld = [&particles](ParticleHandle particle) { return particle.GetStorage() == &particles; };
+
+		std::vector<SceneNetwork> networks;
+		std::vector<SceneSpring> springs;
+		for (const ParticleSpringNetwork* network : world.springNetworks) {
+			networks.push_back({ static_cast<uint32_t>(springs.size()), network->GetSpringCount(),
+				network->implicit, network->maxIterations, network->tolerance });
+
+			for (const ParticleSpringNetwork::Spring& spring : network->GetSprings()) {
+				springs.push_back({ spring.a, spring.b, spring.springConstant, spring.restLength, spring.bungee });
+			}
+		}
+
+		std::vector<SceneLink> cables;
+		std::vector<SceneLink> rods;
+		std::vector<SceneGeometry> geometries;
+		std::vector<ScenePlane> planes;
+		std::vector<SceneSegment> segments;
+		std::vector<ScenePolygon> polygons;
+		std::vector<Vec2> vertices;
+		std::vector<SceneBroadphase> broadphases;
+
+		auto addLinks = [&](const ParticleLinkSet& set, std::vector<SceneLink>& output) {
+			if (set.GetStorage() != &particles) return;
+			for (uint32_t i = 0; i < set.GetLinkCount(); i++) {
+				output.push_back({ set.GetParticle(i, 0).GetIndex(), set.GetParticle(i, 1).GetIndex(), set.GetLength(i), set.GetRestitution(i) });
+			}
+		};
+
+		for (const ParticleContactGenerator* generator : world.contactGenerators) {
+			if (auto set = dynamic_cast<const ParticleCableSet*>(generator)) {
+				addLinks(*set, cables);
+			}
+			else if (auto set = dynamic_cast<const ParticleRodSet*>(generator)) {
+				addLinks(*set, rods);
+			}
+			else if (auto cable = dynamic_cast<const ParticleCable*>(generator)) {
+				if (inWorld(cable->particle[0]) && inWorld(cable->particle[1])) {
+					cables.push_back({ cable->particle[0].GetIndex(), cable->particle[1].GetIndex(), cable->maxLength, cable->restitution });
+				}
+			}
+			else if (auto rod = dynamic_cast<const ParticleRod*>(generator)) {
+				if (inWorld(rod->particle[0]) && inWorld(rod->particle[1])) {
+					rods.push_back({ rod->particle[0].GetIndex(), rod->particle[1].GetIndex(), rod->length, 0 });
+				}
+			}
+			else if (auto ground = dynamic_cast<const StaticContactGenerator*>(generator)) {
+				if (ground->GetStorage() != &particles) continue;
+
+				const StaticGeometry& geometry = *ground->GetGeometry();
+				geometries.push_back({ ground->restitution,
+					static_cast<uint32_t>(planes.size()), static_cast<uint32_t>(geometry.GetPlanes().size()),
+					static_cast<uint32_t>(segments.size()), static_cast<uint32_t>(geometry.GetSegments().size()),
+					static_cast<uint32_t>(polygons.size()), static_cast<uint32_t>(geometry.GetPolygons().size()) });
+
+				for (const StaticGeometry::HalfPlane& plane : geometry.GetPlanes()) {
+					planes.push_back({ plane.normal, plane.offset });
+				}
+				for (const StaticGeometry::Segment& segment : geometry.GetSegments()) {
+					segments.push_back({ segment.a, segment.b });
+				}
+				for (const StaticGeometry::Polygon& polygon : geometry.GetPolygons()) {
+					polygons.push_back({ static_cast<uint32_t>(vertices.size()), polygon.count });
+					vertices.insert(vertices.end(), geometry.GetVertices().begin() + polygon.first,
+						geometry.GetVertices().begin() + polygon.first + polygon.count);
+				}
+			}
+			else if (auto grid = dynamic_cast<const GridBroadphase*>(generator)) {
+				if (grid->GetStorage() == &particles) {
+					broadphases.push_back({ static_cast<uint32_t>(BroadphaseType::Grid), grid->restitution, grid->cellSize });
+				}
+			}
+			else if (auto sweep = dynamic_cast<const SweepAndPruneBroadphase*>(generator)) {
+				if (sweep->GetStorage() == &particles) {
+					broadphases.push_back({ static_cast<uint32_t>(BroadphaseType::SweepAndPrune), sweep->restitution, 0 });
+				}
+			}
+		}
+
+		std::vector<SceneConstraint> constraints;
+		for (uint32_t i = 0; i < world.constraints.GetConstraintCount(); i++) {
+			ParticleHandle a = world.constraints.GetParticle(i, 0);
+			ParticleHandle b = world.constraints.GetParticle(i, 1);
+			if (not inWorld(a) || not inWorld(b)) continue;
+
+			constraints.push_back({ a.GetIndex(), b.GetIndex(), world.constraints.GetLength(i),
+				world.constraints.GetCompliance(i), world.constraints.IsMaxDistance(i) });
+		}
+
+		// Each generator once, in the order they were first registered
+		std::vector<SceneGenerator> generators;
+		std::vector<SceneRegistration> registrations;
+		std::unordered_map<const ParticleForceGenerator*, uint32_t> generatorIndex;
+
+		for (const ParticleForceRegistry::ParticleForceRegistration& registration : world.GetForceRegistry().GetRegistrations()) {
+			if (not inWorld(registration.particle)) continue;
+
+			auto [entry, added] = generatorIndex.try_emplace(registration.fg, INVALID_PARTICLE);
+			if (added) {
+				SceneGenerator record;
+				if (DescribeGenerator(registration.fg, particles, record)) {
+					entry->second = static_cast<uint32_t>(generators.size());
+					generators.push_back(record);
+				}
+			}
+
+			if (entry->second != INVALID_PARTICLE) {
+				registrations.push_back({ registration.particle.GetIndex(), entry->second });
+			}
+		}
+
+		// Sections in file order
+		struct Payload {
+			const void* data;
+			size_t count;
+		};
+
+		auto payload = [](const auto& elements) { return Payload{ elements.data(), elements.size() }; };
+
+		Payload payloads[SECTION_COUNT] = {
+			payload(particles.positionX), payload(particles.positionY),
+			payload(particles.velocityX), payload(particles.velocityY),
+			payload(particles.accelerationX), payload(particles.accelerationY),
+			payload(particles.inverseMass), payload(particles.damping),
+			payload(particles.radius), payload(particles.awake),
+			payload(networks), payload(springs),
+			payload(cables), payload(rods), payload(constraints),
+			payload(geometries), payload(planes), payload(segments), payload(polygons), payload(vertices),
+			payload(broadphases), payload(generators), payload(registrations)
+		};
+
+		SceneHeader header = {};
+		header.magic = SCENE_MAGIC;
+		header.version = SCENE_VERSION;
+		header.particleCount = particles.Size();
+		header.sectionCount = SECTION_COUNT;
+
+		uint64_t offset = sizeof(header);
+		for (uint32_t s = 0; s < SECTION_COUNT; s++) {
+			header.sections[s] = { offset, payloads[s].count };
+			offset += payloads[s].count * SECTION_ELEMENT_SIZE[s];
+			offset = (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+		}
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (not file) return false;
+
+		const char padding[SECTION_ALIGNMENT] = {};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		for (uint32_t s = 0; s < SECTION_COUNT; s++) {
+			uint64_t bytes = payloads[s].count * SECTION_ELEMENT_SIZE[s];
+			uint64_t end = s + 1 < SECTION_COUNT ? header.sections[s + 1].offset : offset;
+
+			if (bytes > 0) file.write(static_cast<const char*>(payloads[s].data), static_cast<std::streamsize>(bytes));
+			file.write(padding, static_cast<std::streamsize>(end - header.sections[s].offset - bytes));
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	// FILE
+
+	SceneFile::~SceneFile() {
+		Close();
+	}
+
+	bool SceneFile::Open(const char* path) {
+		Close();
+
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		HANDLE mapping = nullptr;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= static_cast<LONGLONG>(sizeof(SceneHeader))) {
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		}
+		CloseHandle(file);
+		if (mapping == nullptr) return false;
+
+		// The view keeps the mapping alive
+		data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		CloseHandle(mapping);
+		if (data == nullptr) return false;
+		size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		int file = open(path, O_RDONLY);
+		if (file < 0) return false;
+
+		struct stat status;
+		void* view = MAP_FAILED;
+		if (fstat(file, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(SceneHeader))) {
+			view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		}
+		close(file);
+		if (view == MAP_FAILED) return false;
+
+		data = static_cast<const std::byte*>(view);
+		size = static_cast<size_t>(status.st_size);
+#endif
+
+		if (not IsValid(GetBytes())) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void SceneFile::Close() {
+		if (data == nullptr) return;
+
+#if defined(_WIN32)
+		UnmapViewOfFile(data);
+#else
+		munmap(const_cast<std::byte*>(data), size);
+#endif
+		data = nullptr;
+		size = 0;
+	}
+
+	uint32_t SceneFile::GetParticleCount() const {
+		BR_ASSERT(IsOpen());
+		return Header(GetBytes()).particleCount;
+	}
+
+	// LOAD
+
+	bool Scene::Load(World& world, const char* path) {
+		SceneFile file;
+		if (not file.Open(path)) return false;
+
+		return Load(world, file);
+	}
+
+	bool Scene::Load(World& world, const SceneFile& file) {
+		BR_ASSERT(file.IsOpen());
+		BR_ASSERT(not loaded);
+
+		std::span<const std::byte> bytes = file.GetBytes();
+		if (not HasValidReferences(bytes)) return false;
+		loaded = true;
+
+		ParticleStorage& storage = world.GetParticles();
+
+		firstParticle = storage.Size();
+		particleCount = file.GetParticleCount();
+
+		auto particle = [&](uint32_t index) {
+			BR_ASSERT(index < particleCount);
+			return ParticleHandle(&storage, firstParticle + index);
+		};
+
+		// Columns not in the file start zeroed, like ParticleStorage::Add leaves them
+		uint32_t size = firstParticle + particleCount;
+		storage.ForEachColumn([size](auto& column) { column.resize(size); });
+
+		auto copyColumn = [&](Section section, std::vector<float>& column) {
+			std::span<const float> source = Get<float>(bytes, section);
+			std::copy(source.begin(), source.end(), column.begin() + firstParticle);
+		};
+
+		copyColumn(POSITION_X, storage.positionX);
+		copyColumn(POSITION_Y, storage.positionY);
+		copyColumn(VELOCITY_X, storage.velocityX);
+		copyColumn(VELOCITY_Y, storage.velocityY);
+		copyColumn(ACCELERATION_X, storage.accelerationX);
+		copyColumn(ACCELERATION_Y, storage.accelerationY);
+		copyColumn(INVERSE_MASS, storage.inverseMass);
+		copyColumn(DAMPING, storage.damping);
+		copyColumn(RADIUS, storage.radius);
+		copyColumn(AWAKE, storage.awake);
+		copyColumn(POSITION_X, storage.previousPositionX);
+		copyColumn(POSITION_Y, storage.previousPositionY);
+		std::fill(storage.dampingFactor.begin() + firstParticle, storage.dampingFactor.end(), 1.0f);
+
+		std::span<const SceneSpring> springs = Get<SceneSpring>(bytes, SPRINGS);
+		for (const SceneNetwork& record : Get<SceneNetwork>(bytes, NETWORKS)) {
+			BR_ASSERT(record.firstSpring + uint64_t(record.springCount) <= springs.size());
+
+			auto network = std::make_unique<ParticleSpringNetwork>(&storage);
+			network->implicit = record.implicit != 0;
+			network->maxIterations = record.maxIterations;
+			network->tolerance = record.tolerance;
+
+			for (const SceneSpring& spring : springs.subspan(record.firstSpring, record.springCount)) {
+				if (spring.bungee) network->AddBungee(particle(spring.a), particle(spring.b), spring.springConstant, spring.restLength);
+				else network->AddSpring(particle(spring.a), particle(spring.b), spring.springConstant, spring.restLength);
+			}
+
+			world.AddSpringNetwork(network.get());
+			networks.push_back(std::move(network));
+		}
+
+		std::span<const SceneLink> cableRecords = Get<SceneLink>(bytes, CABLES);
+		if (not cableRecords.empty()) {
+			cables = std::make_unique<ParticleCableSet>(&storage);
+			for (const SceneLink& cable : cableRecords) {
+				cables->AddCable(particle(cable.a), particle(cable.b), cable.length, cable.restitution);
+			}
+			world.AddContactGenerator(cables.get());
+		}
+
+		std::span<const SceneLink> rodRecords = Get<SceneLink>(bytes, RODS);
+		if (not rodRecords.empty()) {
+			rods = std::make_unique<ParticleRodSet>(&storage);
+			for (const SceneLink& rod : rodRecords) {
+				rods->AddRod(particle(rod.a), particle(rod.b), rod.length);
+			}
+			world.AddContactGenerator(rods.get());
+		}
+
+		for (const SceneConstraint& constraint : Get<SceneConstraint>(bytes, CONSTRAINTS)) {
+			if (constraint.maxDistance) world.constraints.AddMaxDistance(particle(constraint.a), particle(constraint.b), constraint.length, constraint.compliance);
+			else world.constraints.AddDistance(particle(constraint.a), particle(constraint.b), constraint.length, constraint.compliance);
+		}
+
+		std::span<const ScenePlane> planes = Get<ScenePlane>(bytes, PLANES);
+		std::span<const SceneSegment> segments = Get<SceneSegment>(bytes, SEGMENTS);
+		std::span<const ScenePolygon> polygons = Get<ScenePolygon>(bytes, POLYGONS);
+		std::span<const Vec2> vertices = Get<Vec2>(bytes, VERTICES);
+
+		for (const SceneGeometry& record : Get<SceneGeometry>(bytes, GEOMETRIES)) {
+			BR_ASSERT(record.firstPlane + uint64_t(record.planeCount) <= planes.size());
+			BR_ASSERT(record.firstSegment + uint64_t(record.segmentCount) <= segments.size());
+			BR_ASSERT(record.firstPolygon + uint64_t(record.polygonCount) <= polygons.size());
+
+			auto geometry = std::make_unique<StaticGeometry>();
+			for (const ScenePlane& plane : planes.subspan(record.firstPlane, record.planeCount)) {
+				geometry->AddPlane(plane.normal, plane.offset);
+			}
+			for (const SceneSegment& segment : segments.subspan(record.firstSegment, record.segmentCount)) {
+				geometry->AddSegment(segment.a, segment.b);
+			}
+			for (const ScenePolygon& polygon : polygons.subspan(record.firstPolygon, record.polygonCount)) {
+				BR_ASSERT(polygon.firstVertex + uint64_t(polygon.vertexCount) <= vertices.size());
+				geometry->AddPolygon(vertices.subspan(polygon.firstVertex, polygon.vertexCount));
+			}
+			geometry->Build();
+
+			auto generator = std::make_unique<StaticContactGenerator>(&storage, geometry.get());
+			generator->restitution = record.restitution;
+			world.AddContactGenerator(generator.get());
+
+			geometries.push_back(std::move(geometry));
+			geometryGenerators.push_back(std::move(generator));
+		}
+
+		for (const SceneBroadphase& record : Get<SceneBroadphase>(bytes, BROADPHASES)) {
+			BroadphaseType type = static_cast<BroadphaseType>(record.type);
+			BR_ASSERT(type == BroadphaseType::Grid || type == BroadphaseType::SweepAndPrune);
+
+			std::unique_ptr<ParticleBroadphase> broadphase = CreateBroadphase(type, &storage);
+			broadphase->restitution = record.restitution;
+			if (type == BroadphaseType::Grid) static_cast<GridBroadphase&>(*broadphase).cellSize = record.cellSize;
+
+			world.AddContactGenerator(broadphase.get());
+			broadphases.push_back(std::move(broadphase));
+		}
+
+		uint32_t firstGenerator = static_cast<uint32_t>(forceGenerators.size());
+		for (const SceneGenerator& record : Get<SceneGenerator>(bytes, GENERATORS)) {
+			const float* v = record.values;
+
+			switch (record.type) {
+			case GeneratorType::Gravity:
+				forceGenerators.push_back(std::make_unique<ParticleGravity>(Vec2(v[0], v[1])));
+				break;
+			case GeneratorType::Spring:
+				forceGenerators.push_back(std::make_unique<ParticleSpring>(particle(record.other), v[0], v[1]));
+				break;
+			case GeneratorType::AnchoredSpring:
+				forceGenerators.push_back(std::make_unique<AnchoredParticleSpring>(Vec2(v[0], v[1]), v[2], v[3]));
+				break;
+			case GeneratorType::Bungee:
+				forceGenerators.push_back(std::make_unique<ParticleBungee>(particle(record.other), v[0], v[1]));
+				break;
+			case GeneratorType::Buoyancy:
+				forceGenerators.push_back(std::make_unique<ParticleBuoyancy>(v[0], v[1], v[2], v[3]));
+				break;
+			default:
+				BR_ASSERT(false);
+			}
+		}
+
+		for (const SceneRegistration& registration : Get<SceneRegistration>(bytes, REGISTRATIONS)) {
+			BR_ASSERT(firstGenerator + registration.generator < forceGenerators.size());
+			world.AddForceGenToRegistry(particle(registration.particle), forceGenerators[firstGenerator + registration.generator].get());
+		}
+
+		return true;
+	}
+}
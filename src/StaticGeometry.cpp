@@ -0,0 +1,270 @@
+#include <Brise/StaticGeometry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Brise {
+
+	namespace {
+		constexpr uint32_t MAX_LEAF_COLLIDERS = 4;
+
+		Vec2 ClosestPointOnSegment(Vec2 a, Vec2 b, Vec2 point) {
+			Vec2 ab = b - a;
+			float lengthSquared = Dot(ab, ab);
+			if (lengthSquared <= 0) return a;
+
+			float t = std::clamp(Dot(point - a, ab) / lengthSquared, 0.0f, 1.0f);
+			return a + ab * t;
+		}
+
+		AABB Merge(const AABB& a, const AABB& b) {
+			return {
+				{ std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y) },
+				{ std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y) }
+			};
+		}
+	}
+
+	// GEOMETRY
+
+	void StaticGeometry::AddPlane(Vec2 normal, float offset) {
+		float length = Magnitude(normal);
+		planes.push_back({ normal / length, offset / length });
+	}
+
+	void StaticGeometry::AddSegment(Vec2 a, Vec2 b) {
+		segments.push_back({ a, b });
+	}
+
+	void StaticGeometry::AddPolygon(std::span<const Vec2> polygonVertices) {
+		uint32_t first = static_cast<uint32_t>(vertices.size());
+		uint32_t count = static_cast<uint32_t>(polygonVertices.size());
+
+		for (uint32_t i = 0; i < count; i++) {
+			Vec2 edge = polygonVertices[(i + 1) % count] - polygonVertices[i];
+
+			vertices.push_back(polygonVertices[i]);
+			edgeNormals.push_back(Normalize(Vec2(edge.y, -edge.x)));
+		}
+
+		polygons.push_back({ first, count });
+	}
+
+	void StaticGeometry::Build() {
+		colliders.clear();
+		nodes.clear();
+
+		for (uint32_t i = 0; i < segments.size(); i++) {
+			const Segment& s = segments[i];
+			AABB box = {
+				{ std::min(s.a.x, s.b.x), std::min(s.a.y, s.b.y) },
+				{ std::max(s.a.x, s.b.x), std::max(s.a.y, s.b.y) }
+			};
+			colliders.push_back({ ColliderType::Segment, i, box });
+		}
+
+		for (uint32_t i = 0; i < polygons.size(); i++) {
+			const Polygon& polygon = polygons[i];
+			AABB box = { vertices[polygon.first], vertices[polygon.first] };
+			for (uint32_t v = 1; v < polygon.count; v++) {
+				Vec2 vertex = vertices[polygon.first + v];
+				box = Merge(box, { vertex, vertex });
+			}
+			colliders.push_back({ ColliderType::Polygon, i, box });
+		}
+
+		if (colliders.empty()) return;
+
+		nodes.reserve(2 * colliders.size());
+		BuildNode(0, static_cast<uint32_t>(colliders.size()));
+	}
+
+	/// <summary>
+	/// Builds the subtree over colliders [first, first + count), splitting
+	/// the longest axis at the median collider center.
+	/// </summary>
+	/// <returns>Index of the subtree root</returns>
+	uint32_t StaticGeometry::BuildNode(uint32_t first, uint32_t count) {
+		uint32_t index = static_cast<uint32_t>(nodes.size());
+		nodes.push_back({});
+
+		AABB box = colliders[first].box;
+		for (uint32_t i = first + 1; i < first + count; i++) {
+			box = Merge(box, colliders[i].box);
+		}
+
+		if (count <= MAX_LEAF_COLLIDERS) {
+			nodes[index] = { box, first, count };
+			return index;
+		}
+
+		bool splitX = (box.max.x - box.min.x) >= (box.max.y - box.min.y);
+		auto center = [splitX](const Collider& c) {
+			return splitX ? c.box.min.x + c.box.max.x : c.box.min.y + c.box.max.y;
+		};
+
+		uint32_t half = count / 2;
+		std::nth_element(
+			colliders.begin() + first,
+			colliders.begin() + first + half,
+			colliders.begin() + first + count,
+			[&](const Collider& a, const Collider& b) { return center(a) < center(b); }
+		);
+
+		BuildNode(first, half); // Left child is the next node
+		uint32_t right = BuildNode(first + half, count - half);
+
+		nodes[index] = { box, right, 0 };
+		return index;
+	}
+
+	unsigned StaticGeometry::Collide(ParticleHandle particle, float restitution, ParticleContact* contacts, unsigned limit) const {
+		Vec2 position = particle.GetPosition();
+		float radius = particle.GetRadius();
+		unsigned used = 0;
+
+		auto emit = [&](ParticleContact& contact) {
+			contact.particle[0] = particle;
+			contact.particle[1] = ParticleHandle();
+			contact.restitution = restitution;
+			used++;
+		};
+
+		for (const HalfPlane& plane : planes) {
+			float distance = Dot(position, plane.normal) - plane.offset;
+			if (distance >= radius) continue;
+
+			if (used >= limit) return used;
+
+			ParticleContact& contact = contacts[used];
+			contact.contactNormal = plane.normal;
+			contact.penetration = radius - distance;
+			emit(contact);
+		}
+
+		if (nodes.empty()) return used;
+
+		AABB query = {
+			{ position.x - radius, position.y - radius },
+			{ position.x + radius, position.y + radius }
+		};
+
+		uint32_t stack[64];
+		unsigned top = 0;
+		stack[top++] = 0;
+
+		while (top > 0) {
+			uint32_t nodeIndex = stack[--top];
+			const Node& node = nodes[nodeIndex];
+
+			if (not node.box.Overlaps(query)) continue;
+
+			if (node.count == 0) {
+				stack[top++] = node.first;
+				stack[top++] = nodeIndex + 1;
+				continue;
+			}
+
+			for (uint32_t i = node.first; i < node.first + node.count; i++) {
+				const Collider& collider = colliders[i];
+				if (not collider.box.Overlaps(query)) continue;
+
+				if (used >= limit) return used;
+
+				bool hit = collider.type == ColliderType::Segment
+					? CollideSegment(segments[collider.index], position, radius, contacts[used])
+					: CollidePolygon(polygons[collider.index], position, radius, contacts[used]);
+
+				if (hit) emit(contacts[used]);
+			}
+		}
+
+		return used;
+	}
+
+	bool StaticGeometry::CollideSegment(const Segment& segment, Vec2 position, float radius, ParticleContact& contact) const {
+		Vec2 delta = position - ClosestPointOnSegment(segment.a, segment.b, position);
+
+		float distanceSquared = Dot(delta, delta);
+		if (distanceSquared >= radius * radius) return false;
+
+		float distance = std::sqrt(distanceSquared);
+
+		if (distance > 0) {
+			contact.contactNormal = delta / distance;
+		}
+		else {
+			// Center right on the segment, push along its normal
+			Vec2 edge = segment.b - segment.a;
+			contact.contactNormal = Normalize(Vec2(-edge.y, edge.x));
+		}
+
+		contact.penetration = radius - distance;
+		return true;
+	}
+
+	bool StaticGeometry::CollidePolygon(const Polygon& polygon, Vec2 position, float radius, ParticleContact& contact) const {
+		// Find the edge the center is the furthest out of
+		float maxSeparation = -std::numeric_limits<float>::max();
+		uint32_t bestEdge = 0;
+
+		for (uint32_t i = 0; i < polygon.count; i++) {
+			uint32_t v = polygon.first + i;
+			float separation = Dot(position - vertices[v], edgeNormals[v]);
+
+			// Separating axis
+			if (separation >= radius) return false;
+
+			if (separation > maxSeparation) {
+				maxSeparation = separation;
+				bestEdge = v;
+			}
+		}
+
+		// Center inside, push out through the closest edge
+		if (maxSeparation <= 0) {
+			contact.contactNormal = edgeNormals[bestEdge];
+			contact.penetration = radius - maxSeparation;
+			return true;
+		}
+
+		// Center outside, the closest boundary point may be a vertex
+		float bestDistanceSquared = std::numeric_limits<float>::max();
+		Vec2 bestDelta = { 0, 0 };
+
+		for (uint32_t i = 0; i < polygon.count; i++) {
+			Vec2 a = vertices[polygon.first + i];
+			Vec2 b = vertices[polygon.first + (i + 1) % polygon.count];
+			Vec2 delta = position - ClosestPointOnSegment(a, b, position);
+
+			float distanceSquared = Dot(delta, delta);
+			if (distanceSquared < bestDistanceSquared) {
+				bestDistanceSquared = distanceSquared;
+				bestDelta = delta;
+			}
+		}
+
+		if (bestDistanceSquared >= radius * radius) return false;
+
+		float distance = std::sqrt(bestDistanceSquared);
+		contact.contactNormal = bestDelta / distance;
+		contact.penetration = radius - distance;
+		return true;
+	}
+
+	// CONTACT GENERATOR
+
+	StaticContactGenerator::StaticContactGenerator(ParticleStorage* particles, const StaticGeometry* geometry)
+		: particles(particles), geometry(geometry) {
+	}
+
+	unsigned StaticContactGenerator::AddContact(ParticleContact& contact, unsigned limit) const {
+		return GenerateInOrder(particles->Size(), &contact, limit, [this](uint32_t i, ParticleContact* output, unsigned limit) {
+			// Nothing to resolve against infinite mass or sleeping particles
+			if (not particles->IsSimulated(i)) return 0u;
+
+			return geometry->Collide(ParticleHandle(particles, i), restitution, output, limit);
+		});
+	}
+}
@@ -0,0 +1,158 @@
+#include <Brise/ThreadPool.h>
+
+#include <algorithm>
+
+#if defined(_WIN32)
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace Brise {
+
+	namespace {
+		// Several chunks per thread let the fast threads steal from the slow ones
+		constexpr uint32_t CHUNKS_PER_THREAD = 4;
+
+		void PinToCore(std::thread& thread, unsigned core) {
+#if defined(_WIN32)
+			SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (core % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(core, &set);
+			pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+			// Pinning isn't supported here, the OS schedules the thread
+			(void)thread;
+			(void)core;
+#endif
+		}
+	}
+
+	ThreadPool::ThreadPool(unsigned threadCount, bool pinThreads) {
+		unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+		if (threadCount == 0) threadCount = cores;
+
+		for (unsigned i = 0; i < threadCount; i++) {
+			queues.push_back(std::make_unique<TaskQueue>());
+		}
+
+		// The calling thread works too, as thread 0
+		for (unsigned i = 1; i < threadCount; i++) {
+			workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+			if (pinThreads) PinToCore(workers.back(), i % cores);
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+	uint32_t ThreadPool::GetChunkCount(uint32_t count, uint32_t minChunk) const {
+		if (workers.empty() || count == 0) return 1;
+
+		uint32_t byMinimum = (count + std::max(minChunk, 1u) - 1) / std::max(minChunk, 1u);
+		return std::max(1u, std::min(byMinimum, GetThreadCount() * CHUNKS_PER_THREAD));
+	}
+
+	void ThreadPool::ParallelFor(uint32_t count, uint32_t minChunk, const RangeFunction& function) {
+		ParallelForChunks(count, minChunk, [&function](uint32_t, uint32_t begin, uint32_t end, unsigned worker) {
+			function(begin, end, worker);
+		});
+	}
+
+	void ThreadPool::ParallelForChunks(uint32_t count, uint32_t minChunk, const ChunkFunction& function) {
+		if (count == 0) return;
+
+		uint32_t chunkCount = GetChunkCount(count, minChunk);
+		if (chunkCount == 1) {
+			function(0, 0, count, 0);
+			return;
+		}
+
+		// Set before any chunk can run, the queue locks publish them to the workers
+		job = &function;
+		pendingTasks.store(chunkCount, std::memory_order_release);
+
+		// Consecutive chunks go to the same thread, it keeps neighbouring data
+		unsigned threads = GetThreadCount();
+		for (uint32_t c = 0; c < chunkCount; c++) {
+			uint32_t begin = static_cast<uint32_t>(uint64_t(count) * c / chunkCount);
+			uint32_t end = static_cast<uint32_t>(uint64_t(count) * (c + 1) / chunkCount);
+			unsigned owner = static_cast<unsigned>(uint64_t(c) * threads / chunkCount);
+
+			std::lock_guard lock(queues[owner]->mutex);
+			queues[owner]->tasks.push_back({ c, begin, end });
+		}
+
+		{
+			std::lock_guard lock(mutex);
+			generation++;
+		}
+		wake.notify_all();
+
+		while (pendingTasks.load(std::memory_order_acquire) > 0) {
+			if (not RunTask(0)) std::this_thread::yield();
+		}
+	}
+
+	void ThreadPool::WorkerLoop(unsigned worker) {
+		uint64_t seenGeneration = 0;
+
+		while (true) {
+			{
+				std::unique_lock lock(mutex);
+				wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+				if (stopping) return;
+
+				seenGeneration = generation;
+			}
+
+			while (RunTask(worker)) {}
+		}
+	}
+
+	bool ThreadPool::RunTask(unsigned worker) {
+		Task task;
+		bool found = false;
+
+		// Own queue from the back, the chunks it was given last
+		{
+			TaskQueue& own = *queues[worker];
+			std::lock_guard lock(own.mutex);
+			if (not own.tasks.empty()) {
+				task = own.tasks.back();
+				own.tasks.pop_back();
+				found = true;
+			}
+		}
+
+		// Steal from the front of the others
+		for (unsigned i = 1; not found && i < queues.size(); i++) {
+			TaskQueue& victim = *queues[(worker + i) % queues.size()];
+			std::lock_guard lock(victim.mutex);
+			if (not victim.tasks.empty()) {
+				task = victim.tasks.front();
+				victim.tasks.pop_front();
+				found = true;
+			}
+		}
+
+		if (not found) return false;
+
+		(*job)(task.chunk, task.begin, task.end, worker);
+		pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+}
@@ -12,29 +12,6 @@ namespace Brise
 		return ((&x)[i]);
 	}
 
-	Vec2& Vec2::operator *=(float s)
-	{
-		x *= s; y *= s;
-		return (*this);
-	}
-	
-	Vec2& Vec2::operator /=(float s)
-	{
-		x /= s; y /= s;
-		return (*this);
-	}
-
-	Vec2& Vec2::operator +=(const Vec2& v)
-	{
-		x += v.x, y += v.y;
-		return (*this);
-	}
-	Vec2& Vec2::operator -=(const Vec2& v)
-	{
-		x -= v.x; y -= v.y;
-		return (*this);
-	}
-
 	std::ostream& operator<<(std::ostream& os, const Vec2& v)
 	{
 		std::cout << "(" << v[0] << ", " << v[1] << ")";
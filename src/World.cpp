@@ -1,61 +1,265 @@
 #include <Brise/World.h>
+#include <Brise/Integrator.h>
+#include <Brise/BriseAssert.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 
 namespace Brise {
+	namespace {
+		constexpr uint32_t STATE_MAGIC = 0x54535242; // "BRST"
+		constexpr uint32_t STATE_VERSION = 1;
+
+		struct StateHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t particleCount;
+			uint32_t cachedImpulses;
+			uint32_t sleepGroups;
+			uint32_t generatorCount;
+			uint64_t generatorBytes;
+			float accumulator;
+			float dampingFactorDuration;
+			uint32_t dampingFactorCount;
+			uint32_t previousAccelerationCount;
+		};
+
+		// The cache follows the header, keep it aligned
+		static_assert(sizeof(StateHeader) % alignof(SequentialImpulseSolver::CachedImpulse) == 0);
+	}
+
 	World::World(size_t numParticles, float fixedTimeStep)
 	: resolver(0), fixedDt(fixedTimeStep) {
 		Init(numParticles);
 	}
 
+	void World::Clear() {
+		particles.Clear();
+		forceRegistry.Clear();
+		contactGenerators.clear();
+		springNetworks.clear();
+		constraints.Clear();
+		links.clear();
+
+		islands.SetSleepGroups({});
+		impulseSolver.ClearCache();
+
+		accumulator = 0;
+		updateStats = {};
+		contactStats = {};
+		stepTimings = {};
+		profiler.Clear();
+	}
+
 	void World::Update(float deltaTime) {
+		auto start = std::chrono::steady_clock::now();
+		auto elapsed = [start] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+
 		accumulator += deltaTime;
 
+		updateStats.steps = 0;
+		updateStats.largestStep = 0;
+		updateStats.degraded = false;
+		updateStats.droppedTime = 0;
+
 		while (accumulator >= fixedDt)
 		{
-			Step(fixedDt);
-			accumulator -= fixedDt;
+			double spent = elapsed();
+			if (maxStepsPerUpdate > 0 && updateStats.steps >= maxStepsPerUpdate) break;
+			if (timeBudget > 0 && updateStats.steps > 0 && spent >= timeBudget) break;
+
+			// Steps still allowed by the cap and by the budget at the average step cost
+			unsigned pending = static_cast<unsigned>(accumulator / fixedDt);
+			unsigned allowed = pending;
+			if (maxStepsPerUpdate > 0) allowed = std::min(allowed, maxStepsPerUpdate - updateStats.steps);
+			if (timeBudget > 0 && stepCost > 0) {
+				double affordable = std::max(1.0, (timeBudget - spent) / stepCost);
+				allowed = static_cast<unsigned>(std::min<double>(allowed, affordable));
+			}
+
+			// Behind, cover more time per step
+			unsigned scale = 1;
+			if (pending > allowed) {
+				scale = std::min({ maxStepScale, (pending + allowed - 1) / allowed, pending });
+			}
+
+			float stepDuration = fixedDt * scale;
+			auto stepStart = elapsed();
+
+			if (scale > 1) {
+				unsigned iterations = impulseSolver.GetIterations();
+				impulseSolver.SetIterations(std::max(1u, iterations / 2));
+				Step(stepDuration);
+				impulseSolver.SetIterations(iterations);
+				updateStats.degraded = true;
+			}
+			else {
+				Step(stepDuration);
+			}
+
+			double cost = (elapsed() - stepStart) / scale;
+			stepCost = stepCost > 0 ? 0.9 * stepCost + 0.1 * cost : cost;
+
+			accumulator -= stepDuration;
+			updateStats.steps++;
+			updateStats.largestStep = std::max(updateStats.largestStep, stepDuration);
 		}
 
+		// Whole steps left over can't be caught up with, keep the fraction only
+		if (accumulator >= fixedDt) {
+			float dropped = std::floor(accumulator / fixedDt) * fixedDt;
+			accumulator -= dropped;
+			updateStats.droppedTime = dropped;
+			updateStats.totalDroppedTime += dropped;
+		}
+
+		updateStats.elapsed = elapsed();
+		profiler.RecordUpdate(updateStats.steps);
+	}
+
+	float World::GetFixedTimeStep() const {
+		return fixedDt;
+	}
+
+	void World::SetMaxStepsPerUpdate(unsigned max) {
+		maxStepsPerUpdate = max;
+	}
+
+	unsigned World::GetMaxStepsPerUpdate() const {
+		return maxStepsPerUpdate;
+	}
+
+	void World::SetTimeBudget(float seconds) {
+		BR_ASSERT(seconds >= 0);
+		timeBudget = seconds;
+	}
+
+	float World::GetTimeBudget() const {
+		return timeBudget;
+	}
+
+	void World::SetMaxStepScale(unsigned scale) {
+		maxStepScale = std::max(1u, scale);
+	}
+
+	unsigned World::GetMaxStepScale() const {
+		return maxStepScale;
+	}
+
+	const UpdateStats& World::GetUpdateStats() const {
+		return updateStats;
+	}
+
+	const StepTimings& World::GetStepTimings() const {
+		return stepTimings;
+	}
+
+	WorldProfiler& World::GetProfiler() {
+		return profiler;
+	}
+
+	const WorldProfiler& World::GetProfiler() const {
+		return profiler;
+	}
+
+	float World::GetInterpolationAlpha() const {
+		return std::clamp(accumulator / fixedDt, 0.0f, 1.0f);
+	}
+
+	InterpolatedPositions World::GetInterpolatedPositions() const {
+		return InterpolatedPositions(&particles, GetInterpolationAlpha());
 	}
 
 	void World::Step(float fixedDt) {
-		// Apply the force generators
-		forceRegistry.UpdateForces(fixedDt);
+		PhaseTimer timer;
+		particles.SavePreviousPositions();
 
-		// Integrate the particles
-		for (auto& p : particles) {
-			p.Integrate(fixedDt);
+		// Apply the force generators
+		forceRegistry.UpdateForces(fixedDt, threadPool.get());
+		for (ParticleSpringNetwork* network : springNetworks) {
+			network->UpdateForces(fixedDt, threadPool.get());
 		}
+		stepTimings.forces = timer.Lap();
+
+		// Integrate the particles, the constrained ones in substeps
+		constraints.Prepare(particles);
+		IntegrateParticles(particles, fixedDt, threadPool.get(), integrator);
+		constraints.Solve(particles, fixedDt);
+		stepTimings.integration = timer.Lap();
 
 		// Generate Contacts
 		unsigned usedContacts = GenerateContacts();
+		stepTimings.contacts = timer.Lap();
+		profiler.RecordContacts({ contacts.data(), usedContacts });
+
+		// Group the particles that interact, for sleeping and to solve them in parallel.
+		// Only the impulse solver runs islands in parallel, the iterative resolver stays serial.
+		bool useIslands = sleeping || (threadPool && contactSolver == ContactSolver::SequentialImpulse);
+		if (useIslands) {
+			CollectLinks();
+			islands.Build(particles, contacts, usedContacts, links);
+		}
+		stepTimings.islands = timer.Lap();
 
 		// Process the contacts
-		if (usedContacts) {
+		if (contactSolver == ContactSolver::SequentialImpulse) {
+			// Runs even without contacts so stale cached impulses are dropped
+			impulseSolver.Solve(contacts, usedContacts, fixedDt, useIslands ? &islands : nullptr);
+		}
+		else if (usedContacts) {
 			resolver.SetIterations(usedContacts);
 			resolver.ResolveContacts(contacts, usedContacts, fixedDt);
 		}
+		stepTimings.resolution = timer.Lap();
+
+		if (sleeping) {
+			islands.UpdateSleep(particles);
+		}
+		stepTimings.sleeping = timer.Lap();
+
+		unsigned iterationsUsed = 0;
+		if (contactSolver == ContactSolver::SequentialImpulse) iterationsUsed = impulseSolver.GetIterationsUsed();
+		else if (usedContacts) iterationsUsed = resolver.GetIterationsUsed();
+		profiler.RecordStep(stepTimings, iterationsUsed);
 	}
 
-	Particle& World::AddParticule(Vec2 position, float mass, float damping) {
-		particles.push_back(Particle(position, mass, damping));
-		particles.back().acceleration = gravity; // Set world gravity as constant acceleration
+	ParticleHandle World::AddParticule(Vec2 position, float mass, float damping) {
+		ParticleHandle particle(&particles, particles.Add(position, mass, damping));
+		particle.SetAcceleration(gravity); // Set world gravity as constant acceleration
+
+		return particle;
+	}
+
+	ParticleHandle World::GetParticle(uint32_t index) {
+		return ParticleHandle(&particles, index);
+	}
 
-		return particles.back();
+	uint32_t World::GetParticleCount() const {
+		return particles.Size();
 	}
 
-	void World::AddForceGenToRegistry(Particle* particle, ParticleForceGenerator* fg) {
+	void World::AddForceGenToRegistry(ParticleHandle particle, ParticleForceGenerator* fg) {
 		forceRegistry.Add(particle, fg);
 	}
 
+	const ParticleForceRegistry& World::GetForceRegistry() const {
+		return forceRegistry;
+	}
+
+	World::ParticleContainer& World::GetParticles() {
+		return particles;
+	}
+
 	const World::ParticleContainer& World::GetParticles() const {
 		return particles;
 	}
 
 	void World::Init(size_t numParticles) {
-		particles.reserve(numParticles);
+		particles.Reserve(numParticles);
 		SetGravity({ 0, -9.81 }); // Default to real world gravity acceleration
-		maxContacts = 100;
-		contacts.resize(maxContacts);
+		contacts.resize(DEFAULT_CONTACT_CAPACITY);
 	}
 
 	void World::Shutdown() {}
@@ -69,32 +273,247 @@ namespace Brise {
 	}
 
 	unsigned World::GenerateContacts() {
-		unsigned limit = maxContacts;
 		unsigned nextContact = 0;
+		contactStats.dropped = 0;
+		contactStats.regrowths = 0;
 
 		for (auto generator : contactGenerators) {
-			if (nextContact >= limit)
-				break;
+			while (true) {
+				if (nextContact == contacts.size() && not GrowContacts()) {
+					contactStats.dropped += CountContacts(*generator);
+					break;
+				}
+
+				unsigned room = static_cast<unsigned>(contacts.size()) - nextContact;
+				unsigned used = generator->AddContacts(std::span(contacts).subspan(nextContact, room));
 
-			unsigned used = generator->AddContact(
-				contacts[nextContact],
-				limit - nextContact
-			);
+				if (used < room) {
+					nextContact += used;
+					break;
+				}
 
-			nextContact += used;
+				// The generator filled the buffer and may have more,
+				// run it again with more room unless at the maximum
+				if (not GrowContacts()) {
+					nextContact += used;
+					contactStats.dropped += CountContacts(*generator) - used;
+					break;
+				}
+			}
 		}
 
+		contactStats.generated = nextContact;
+		contactStats.capacity = static_cast<unsigned>(contacts.size());
+		contactStats.highWaterMark = std::max(contactStats.highWaterMark, nextContact);
+
 		return nextContact;
 	}
 
+	bool World::GrowContacts() {
+		size_t size = contacts.size();
+		if (maxContacts > 0 && size >= maxContacts) return false;
+
+		size = std::max<size_t>(2 * size, DEFAULT_CONTACT_CAPACITY);
+		if (maxContacts > 0) size = std::min<size_t>(size, maxContacts);
+
+		contacts.resize(size);
+		contactStats.regrowths++;
+		return true;
+	}
+
+	/// <summary>
+	/// Counts every contact of a generator, in a scratch buffer growing as needed.
+	/// Only used once contacts are dropped, to report how many.
+	/// </summary>
+	unsigned World::CountContacts(const ParticleContactGenerator& generator) {
+		if (droppedContacts.empty()) droppedContacts.resize(DEFAULT_CONTACT_CAPACITY);
+
+		while (true) {
+			unsigned room = static_cast<unsigned>(droppedContacts.size());
+			unsigned used = generator.AddContacts(droppedContacts);
+			if (used < room) return used;
+
+			droppedContacts.resize(2 * droppedContacts.size());
+		}
+	}
+
+	void World::SetMaxContacts(unsigned max) {
+		maxContacts = max;
+		if (maxContacts > 0 && contacts.size() > maxContacts) contacts.resize(maxContacts);
+	}
+
+	unsigned World::GetMaxContacts() const {
+		return maxContacts;
+	}
+
+	const ContactStats& World::GetContactStats() const {
+		return contactStats;
+	}
+
+	void World::SetContactSolver(ContactSolver solver) {
+		if (solver != contactSolver) impulseSolver.ClearCache();
+		contactSolver = solver;
+	}
+
+	ContactSolver World::GetContactSolver() const {
+		return contactSolver;
+	}
+
+	void World::SetIntegrator(IntegratorType type) {
+		integrator = type;
+	}
+
+	IntegratorType World::GetIntegrator() const {
+		return integrator;
+	}
+
+	void World::SetThreadCount(unsigned count, bool pinThreads) {
+		threadPool.reset();
+		if (count > 0) threadPool = std::make_unique<ThreadPool>(count, pinThreads);
+
+		impulseSolver.SetThreadPool(threadPool.get());
+		for (ParticleContactGenerator* generator : contactGenerators) {
+			generator->SetThreadPool(threadPool.get());
+		}
+	}
+
+	unsigned World::GetThreadCount() const {
+		return threadPool ? threadPool->GetThreadCount() : 0;
+	}
+
+	void World::SetSleeping(bool enabled) {
+		if (sleeping && not enabled) islands.WakeAll(particles);
+		sleeping = enabled;
+	}
+
+	bool World::IsSleeping() const {
+		return sleeping;
+	}
+
+	void World::CollectLinks() {
+		links.clear();
+
+		for (const ParticleContactGenerator* generator : contactGenerators) {
+			generator->CollectLinks(links);
+		}
+		for (const ParticleSpringNetwork* network : springNetworks) {
+			network->CollectLinks(links);
+		}
+		constraints.CollectLinks(links);
+		forceRegistry.CollectLinks(links);
+	}
+
 	void World::AddContactGenerator(ParticleContactGenerator* generator) {
+		generator->SetThreadPool(threadPool.get());
 		contactGenerators.push_back(generator);
 	}
 
 	void World::RemoveContactGenerator(ParticleContactGenerator* generator) {
+		generator->SetThreadPool(nullptr);
 		contactGenerators.erase(
 			std::remove(contactGenerators.begin(), contactGenerators.end(), generator),
 			contactGenerators.end()
 		);
 	}
-}
\ No newline at end of file
+
+	void World::AddSpringNetwork(ParticleSpringNetwork* network) {
+		BR_ASSERT(network->GetStorage() == &particles);
+		springNetworks.push_back(network);
+	}
+
+	void World::RemoveSpringNetwork(ParticleSpringNetwork* network) {
+		springNetworks.erase(
+			std::remove(springNetworks.begin(), springNetworks.end(), network),
+			springNetworks.end()
+		);
+	}
+
+	// STATE
+
+	void World::SaveState(WorldState& state) {
+		std::span<ParticleForceGenerator* const> generators = forceRegistry.GetGenerators();
+		std::span<const SequentialImpulseSolver::CachedImpulse> cache = impulseSolver.GetCache();
+		std::span<const uint32_t> sleepGroups = islands.GetSleepGroups();
+
+		StateHeader header = {};
+		header.magic = STATE_MAGIC;
+		header.version = STATE_VERSION;
+		header.particleCount = particles.Size();
+		header.cachedImpulses = static_cast<uint32_t>(cache.size());
+		header.sleepGroups = static_cast<uint32_t>(sleepGroups.size());
+		header.generatorCount = static_cast<uint32_t>(generators.size());
+		header.accumulator = accumulator;
+		header.dampingFactorDuration = particles.dampingFactorDuration;
+		header.dampingFactorCount = particles.dampingFactorCount;
+		header.previousAccelerationCount = particles.previousAccelerationCount;
+
+		for (const ParticleForceGenerator* generator : generators) {
+			header.generatorBytes += generator->GetStateSize();
+		}
+
+		size_t size = sizeof(header) + cache.size_bytes() + sleepGroups.size_bytes() + header.generatorBytes;
+		particles.ForEachColumn([&size](const auto& column) { size += column.size() * sizeof(column[0]); });
+
+		// Never shrinks, a state saved every frame stops allocating
+		state.data.resize(size);
+		std::byte* at = state.data.data();
+
+		auto write = [&at](const void* source, size_t bytes) {
+			if (bytes > 0) std::memcpy(at, source, bytes);
+			at += bytes;
+		};
+
+		write(&header, sizeof(header));
+		write(cache.data(), cache.size_bytes());
+		particles.ForEachColumn([&write](const auto& column) { write(column.data(), column.size() * sizeof(column[0])); });
+		write(sleepGroups.data(), sleepGroups.size_bytes());
+
+		for (const ParticleForceGenerator* generator : generators) {
+			generator->SaveState(at);
+			at += generator->GetStateSize();
+		}
+	}
+
+	void World::RestoreState(const WorldState& state) {
+		BR_ASSERT(state.data.size() >= sizeof(StateHeader));
+
+		StateHeader header;
+		std::memcpy(&header, state.data.data(), sizeof(header));
+		BR_ASSERT(header.magic == STATE_MAGIC && header.version == STATE_VERSION);
+
+		// Particles added since the save go away with their registrations, which leaves the
+		// generators that were registered when saving
+		forceRegistry.RemoveParticlesFrom(header.particleCount);
+		std::span<ParticleForceGenerator* const> generators = forceRegistry.GetGenerators();
+		BR_ASSERT(header.generatorCount == generators.size());
+
+		const std::byte* at = state.data.data() + sizeof(header);
+		auto read = [&at](void* destination, size_t bytes) {
+			if (bytes > 0) std::memcpy(destination, at, bytes);
+			at += bytes;
+		};
+
+		accumulator = header.accumulator;
+
+		impulseSolver.SetCache({ reinterpret_cast<const SequentialImpulseSolver::CachedImpulse*>(at), header.cachedImpulses });
+		at += header.cachedImpulses * sizeof(SequentialImpulseSolver::CachedImpulse);
+
+		particles.ForEachColumn([&](auto& column) {
+			column.resize(header.particleCount);
+			read(column.data(), column.size() * sizeof(column[0]));
+		});
+		particles.dampingFactorDuration = header.dampingFactorDuration;
+		particles.dampingFactorCount = header.dampingFactorCount;
+		particles.previousAccelerationCount = header.previousAccelerationCount;
+
+		islands.SetSleepGroups({ reinterpret_cast<const uint32_t*>(at), header.sleepGroups });
+		at += header.sleepGroups * sizeof(uint32_t);
+
+		for (ParticleForceGenerator* generator : generators) {
+			generator->RestoreState(at);
+			at += generator->GetStateSize();
+		}
+
+		BR_ASSERT(at == state.data.data() + state.data.size());
+	}
+}